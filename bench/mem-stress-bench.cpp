@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "libs/CLI11.hpp"
+#include "memstress/cpu.hpp"
+#include "memstress/kernels.hpp"
+#include "memstress/parallel.hpp"
+
+using memstress::AddressGenerator;
+using memstress::countPatternMismatches;
+using memstress::fillPattern;
+using memstress::invertPosition;
+using memstress::swapPositions;
+using memstress::verifyPatternRange;
+using memstress::writePatternRange;
+
+// Benchmark dos kernels de estresse, cada kernel eh medido isolado variando tamanho do buffer,
+// largura do acesso e quantidade de threads, com repeticoes e estatisticas no estilo do Google Benchmark.
+// A saida CSV pode ser guardada como base e comparada nas proximas execucoes para achar regressoes.
+
+// Quantidade de operacoes entre cada consulta ao relogio nos kernels aleatorios
+const int benchmarkBatch = 4096;
+
+// Evita que o compilador descarte os resultados dos kernels que so leem
+volatile long long benchmarkSink = 0;
+
+struct BenchmarkCase
+{
+    std::string kernel;
+    int width;
+    long long size;
+    int threads;
+
+    std::string name() const
+    {
+        std::ostringstream formatted;
+        formatted << kernel << "/w" << width << "/size:" << size / 1024 << "KiB/threads:" << threads;
+        return formatted.str();
+    }
+};
+
+struct BenchmarkStats
+{
+    double mean;
+    double median;
+    double stddev;
+    double min;
+    double max;
+};
+
+struct BenchmarkResult
+{
+    BenchmarkCase benchmarkCase;
+    BenchmarkStats itemsPerSecond;
+    BenchmarkStats bytesPerSecond;
+};
+
+// Acessos a memoria por item de cada kernel, usado para converter itens/s em bytes/s
+int accessesPerItem(const std::string& kernel)
+{
+    if (kernel == "invert") return 3;  // leitura, escrita e releitura
+    if (kernel == "swap") return 6;    // duas leituras, duas escritas e duas releituras
+    if (kernel == "prng") return 0;
+    return 1;
+}
+
+// Roda o kernel na faixa ate o prazo e retorna a quantidade de itens processados
+template <typename T>
+long long runKernel(const std::string& kernel, volatile T * buffer, long long startIndex, long long finalIndex,
+    std::chrono::time_point<std::chrono::steady_clock> deadline, uint64_t seed)
+{
+    AddressGenerator memPositionGenerator(startIndex, finalIndex, seed);
+    long long items = 0;
+    long long sink = 0;
+
+    do
+    {
+        if (kernel == "write")
+        {
+            writePatternRange(buffer, startIndex, finalIndex);
+            items += finalIndex - startIndex;
+        }
+        else if (kernel == "fill")
+        {
+            fillPattern(const_cast<char *>(reinterpret_cast<volatile char *>(buffer)), startIndex * sizeof(T), finalIndex * sizeof(T));
+            items += finalIndex - startIndex;
+        }
+        else if (kernel == "scan")
+        {
+            sink += countPatternMismatches(const_cast<char *>(reinterpret_cast<volatile char *>(buffer)), startIndex * sizeof(T), finalIndex * sizeof(T));
+            items += finalIndex - startIndex;
+        }
+        else if (kernel == "verify")
+        {
+            sink += verifyPatternRange(buffer, startIndex, finalIndex);
+            items += finalIndex - startIndex;
+        }
+        else if (kernel == "invert")
+        {
+            for (int i = 0; i < benchmarkBatch; i++)
+            {
+                sink += invertPosition(buffer, memPositionGenerator.next());
+            }
+
+            items += benchmarkBatch;
+        }
+        else if (kernel == "swap")
+        {
+            for (int i = 0; i < benchmarkBatch; i++)
+            {
+                long long firstMemoryPosition = memPositionGenerator.next();
+                sink += swapPositions(buffer, firstMemoryPosition, memPositionGenerator.next());
+            }
+
+            items += benchmarkBatch;
+        }
+        else
+        {
+            for (int i = 0; i < benchmarkBatch; i++)
+            {
+                sink ^= memPositionGenerator.next();
+            }
+
+            items += benchmarkBatch;
+        }
+    } while (deadline > std::chrono::steady_clock::now());
+
+    benchmarkSink += sink;
+
+    return items;
+}
+
+// Uma repeticao do caso: divide o buffer entre as threads e retorna itens por segundo
+template <typename T>
+double runRepetition(const BenchmarkCase& benchmarkCase, volatile T * buffer, std::chrono::milliseconds minTime, uint64_t seed)
+{
+    long long elements = benchmarkCase.size / sizeof(T);
+    long long elementsPerThread = elements / benchmarkCase.threads;
+
+    std::vector<long long> items(benchmarkCase.threads, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + minTime;
+
+    // Pelo runParallel as threads usam os kernels escolhidos no --isa, e nao os automaticos
+    memstress::runParallel(benchmarkCase.threads, [&](int i) {
+        long long startIndex = i * elementsPerThread;
+        long long finalIndex = i == benchmarkCase.threads - 1 ? elements : (i + 1) * elementsPerThread;
+
+        items[i] = runKernel(benchmarkCase.kernel, buffer, startIndex, finalIndex, deadline, seed + i);
+    });
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::accumulate(items.begin(), items.end(), 0LL) / elapsed.count();
+}
+
+BenchmarkStats computeStats(std::vector<double> samples)
+{
+    std::sort(samples.begin(), samples.end());
+
+    BenchmarkStats stats;
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    stats.median = samples.size() % 2 == 1
+        ? samples[samples.size() / 2]
+        : (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+    stats.min = samples.front();
+    stats.max = samples.back();
+
+    double squares = 0;
+
+    for (double sample : samples) squares += (sample - stats.mean) * (sample - stats.mean);
+
+    stats.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0;
+
+    return stats;
+}
+
+BenchmarkStats scaleStats(BenchmarkStats stats, double factor)
+{
+    return {stats.mean * factor, stats.median * factor, stats.stddev * factor, stats.min * factor, stats.max * factor};
+}
+
+// Roda todas as repeticoes de um caso, o buffer eh preenchido e aquecido antes para o verify ter o padrao certo
+template <typename T>
+BenchmarkResult runCase(const BenchmarkCase& benchmarkCase, volatile char * storage, int repetitions, std::chrono::milliseconds minTime)
+{
+    volatile T * buffer = reinterpret_cast<volatile T *>(storage);
+
+    // O scan confere o padrao de bytes do fillPattern, os demais o padrao por elemento
+    if (benchmarkCase.kernel == "fill" || benchmarkCase.kernel == "scan")
+    {
+        fillPattern(const_cast<char *>(storage), 0, benchmarkCase.size);
+    } else {
+        writePatternRange(buffer, 0, benchmarkCase.size / static_cast<long long>(sizeof(T)));
+    }
+
+    runRepetition(benchmarkCase, buffer, minTime / 4, 0);
+
+    std::vector<double> samples;
+
+    for (int repetition = 0; repetition < repetitions; repetition++)
+    {
+        samples.push_back(runRepetition(benchmarkCase, buffer, minTime, repetition * 1000003ULL));
+    }
+
+    BenchmarkResult result;
+    result.benchmarkCase = benchmarkCase;
+    result.itemsPerSecond = computeStats(samples);
+    result.bytesPerSecond = scaleStats(result.itemsPerSecond, accessesPerItem(benchmarkCase.kernel) * benchmarkCase.width);
+
+    return result;
+}
+
+BenchmarkResult runCase(const BenchmarkCase& benchmarkCase, volatile char * storage, int repetitions, std::chrono::milliseconds minTime)
+{
+    switch (benchmarkCase.width)
+    {
+        case 2: return runCase<uint16_t>(benchmarkCase, storage, repetitions, minTime);
+        case 4: return runCase<uint32_t>(benchmarkCase, storage, repetitions, minTime);
+        case 8: return runCase<uint64_t>(benchmarkCase, storage, repetitions, minTime);
+        default: return runCase<uint8_t>(benchmarkCase, storage, repetitions, minTime);
+    }
+}
+
+void writeCsv(std::ostream& output, const std::vector<BenchmarkResult>& results, int repetitions)
+{
+    output << "name,kernel,width,size_bytes,threads,repetitions,"
+        << "items_per_second_mean,items_per_second_median,items_per_second_stddev,"
+        << "items_per_second_min,items_per_second_max,bytes_per_second_mean\n";
+
+    for (const auto& result : results)
+    {
+        const BenchmarkCase& benchmarkCase = result.benchmarkCase;
+
+        output << std::setprecision(10)
+            << benchmarkCase.name() << "," << benchmarkCase.kernel << "," << benchmarkCase.width << ","
+            << benchmarkCase.size << "," << benchmarkCase.threads << "," << repetitions << ","
+            << result.itemsPerSecond.mean << "," << result.itemsPerSecond.median << ","
+            << result.itemsPerSecond.stddev << "," << result.itemsPerSecond.min << ","
+            << result.itemsPerSecond.max << "," << result.bytesPerSecond.mean << "\n";
+    }
+}
+
+// Le a mediana de itens/s de cada caso de um CSV gerado anteriormente
+std::map<std::string, double> readBaseline(const std::string& path)
+{
+    std::map<std::string, double> baseline;
+    std::ifstream input(path);
+    std::string line;
+
+    // Pula o cabecalho
+    std::getline(input, line);
+
+    while (std::getline(input, line))
+    {
+        std::vector<std::string> fields;
+        std::stringstream lineStream(line);
+        std::string field;
+
+        while (std::getline(lineStream, field, ',')) fields.push_back(field);
+
+        if (fields.size() < 8) continue;
+
+        baseline[fields[0]] = std::stod(fields[7]);
+    }
+
+    return baseline;
+}
+
+int main(int argc, char **argv)
+{
+    CLI::App app{"Benchmark dos kernels do mem-stress"};
+
+    // fill e scan sao as versoes vetorizaveis de write e verify usadas no buffer inteiro
+    std::vector<std::string> kernels{"write", "verify", "fill", "scan", "invert", "swap", "prng"};
+    app.add_option("--kernels", kernels, "Kernels medidos")
+        ->check(CLI::IsMember({"write", "verify", "fill", "scan", "invert", "swap", "prng"}));
+
+    std::vector<long long> sizesKiB{32, 1024, 64 * 1024};
+    app.add_option("--sizes-kb", sizesKiB, "Tamanhos do buffer em KiB")
+        ->check(CLI::PositiveNumber);
+
+    std::vector<int> widths{1, 8};
+    app.add_option("--widths", widths, "Larguras do acesso em bytes")
+        ->check(CLI::IsMember({1, 2, 4, 8}));
+
+    std::vector<int> threadCounts{1};
+    if (std::thread::hardware_concurrency() > 1) threadCounts.push_back(std::thread::hardware_concurrency());
+    app.add_option("--threads", threadCounts, "Quantidades de threads")
+        ->check(CLI::PositiveNumber);
+
+    int repetitions{3};
+    app.add_option("--repetitions", repetitions, "Repetições de cada caso")
+        ->check(CLI::PositiveNumber);
+
+    int minTimeMs{100};
+    app.add_option("--min-time-ms", minTimeMs, "Duração mínima de cada repetição em ms")
+        ->check(CLI::PositiveNumber);
+
+    std::string filter;
+    app.add_option("--filter", filter, "Roda apenas os casos cujo nome contém o texto");
+
+    std::string csvPath;
+    app.add_option("--csv", csvPath, "Grava os resultados em CSV no arquivo (- para a saída padrão)");
+
+    std::string baselinePath;
+    app.add_option("--compare", baselinePath, "CSV de uma execução anterior para comparar as medianas")
+        ->check(CLI::ExistingFile);
+
+    double threshold{5};
+    app.add_option("--threshold", threshold, "Queda em % da mediana considerada regressão");
+
+    std::map<std::string, memstress::KernelIsa> kernelIsas{
+        {"auto", memstress::KernelIsa::Auto},
+        {"generic", memstress::KernelIsa::Generic},
+        {"sse2", memstress::KernelIsa::Sse2},
+        {"avx2", memstress::KernelIsa::Avx2},
+        {"avx512", memstress::KernelIsa::Avx512}};
+    std::string kernelIsa{"auto"};
+    app.add_option("--isa", kernelIsa, "Conjunto de instruções máximo dos kernels fill e scan")
+        ->check(CLI::IsMember(kernelIsas));
+
+    CLI11_PARSE(app, argc, argv);
+
+    memstress::selectKernels(kernelIsas[kernelIsa]);
+
+    std::cout << "CPU: " << memstress::describeCpuFeatures() << std::endl;
+    std::cout << "Kernels: " << memstress::describeKernelSelection() << "\n" << std::endl;
+
+    std::vector<BenchmarkCase> cases;
+
+    for (const auto& kernel : kernels)
+        for (long long sizeKiB : sizesKiB)
+            for (int width : widths)
+                for (int threads : threadCounts)
+                {
+                    // Os kernels de blocos sempre acessam palavras de 8 bytes
+                    if ((kernel == "fill" || kernel == "scan") && width != widths.back()) continue;
+
+                    BenchmarkCase benchmarkCase{kernel, (kernel == "fill" || kernel == "scan") ? 8 : width, sizeKiB * 1024, threads};
+
+                    if (benchmarkCase.name().find(filter) == std::string::npos) continue;
+
+                    cases.push_back(benchmarkCase);
+                }
+
+    long long maxSize = *std::max_element(sizesKiB.begin(), sizesKiB.end()) * 1024;
+    std::vector<uint64_t> storage(maxSize / sizeof(uint64_t) + 1);
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty()) baseline = readBaseline(baselinePath);
+
+    std::cout << std::left << std::setw(44) << "Benchmark"
+        << std::right << std::setw(14) << "Mediana/s" << std::setw(12) << "CV"
+        << std::setw(12) << "GB/s" << std::setw(12) << "Base" << std::endl;
+    std::cout << std::string(94, '-') << std::endl;
+
+    std::vector<BenchmarkResult> results;
+    int regressions = 0;
+
+    for (const auto& benchmarkCase : cases)
+    {
+        BenchmarkResult result = runCase(benchmarkCase, reinterpret_cast<volatile char *>(storage.data()),
+            repetitions, std::chrono::milliseconds(minTimeMs));
+
+        results.push_back(result);
+
+        std::cout << std::fixed << std::left << std::setw(44) << benchmarkCase.name() << std::right
+            << std::setprecision(2) << std::setw(12) << result.itemsPerSecond.median / 1e6 << " M"
+            << std::setw(11) << result.itemsPerSecond.stddev * 100 / result.itemsPerSecond.mean << "%"
+            << std::setw(12) << result.bytesPerSecond.median / 1e9;
+
+        auto baselineEntry = baseline.find(benchmarkCase.name());
+
+        if (baselineEntry != baseline.end() && baselineEntry->second > 0)
+        {
+            double change = (result.itemsPerSecond.median / baselineEntry->second - 1) * 100;
+            bool regression = change < -threshold;
+
+            regressions += regression;
+
+            std::cout << std::setw(11) << std::showpos << change << "%" << std::noshowpos
+                << (regression ? "  REGRESSÃO" : "");
+        }
+
+        std::cout << std::endl;
+    }
+
+    if (csvPath == "-")
+    {
+        writeCsv(std::cout, results, repetitions);
+    }
+    else if (!csvPath.empty())
+    {
+        std::ofstream csv(csvPath);
+        writeCsv(csv, results, repetitions);
+    }
+
+    if (!baseline.empty())
+    {
+        std::cout << "\nRegressões acima de " << threshold << "%: " << regressions << std::endl;
+    }
+
+    // Codigo de saida diferente de zero para o CI barrar a mudanca
+    return regressions > 0 ? 1 : 0;
+}
@@ -1,187 +1,306 @@
+#include <algorithm>
+#include <csignal>
 #include <iostream>
-#include <cstring>
-#include <random>
-#include <thread>
-#include <chrono>
-#include <mutex>
-#include <vector>
+#include <map>
+#include <new>
 #include <string>
+#include <vector>
 #include "libs/CLI11.hpp"
-#include "sys/sysinfo.h"
-
-#ifdef _WIN32
-    #include <windows.h>
-#endif
+#include "memstress/checkpoint.hpp"
+#include "memstress/session.hpp"
+#include "memstress/system.hpp"
 
-// Buffer que vai alocar a memoria do programa, volatile para evitar que o compilador otimize a leitura/escrita
-volatile char * buffer = nullptr;
-std::mutex bufferMutex;
+namespace
+{
 
-// Contador de erros nas operacoes de memoria
-int errCounter = 0;
+// Sessao em execucao, para o Ctrl+C/SIGTERM encerrar o estresse gravando o checkpoint
+memstress::StressSession * activeSession = nullptr;
 
-long long getTotalAvailableVirtualMemory()
+void requestStop(int)
 {
+    if (activeSession) activeSession->stop();
+}
 
-    #ifdef linux
-        // cria uma variavel do tipo sysinfo
-        struct sysinfo memInfo;
+} // namespace
 
-        // popula a veriavel com os dados do sistema
-        sysinfo(&memInfo);
+int main(int argc, char **argv)
+{
+    // inicializa o CLI11, lib para passar parametros no executavel
+    CLI::App app;
 
-        // inicializa com o total de memoria disponivel
-        long long totalMem = memInfo.freeram + memInfo.freeswap;
-        totalMem *= memInfo.mem_unit; // converte para bytes
+    memstress::StressConfig config;
 
-        return totalMem;
-    #endif
+    app.add_option("--threads", config.threads, "Quantidade de threads para estressar a memória, por padrão derivada da topologia")
+        ->check(CLI::PositiveNumber);
 
-    #ifdef _WIN32
-        MEMORYSTATUSEX status;
-        status.dwLength = sizeof(status);
-        GlobalMemoryStatusEx(&status);
-        return status.ullAvailPageFile;
-    #endif
-}
+    std::map<std::string, memstress::PlacementPolicy> placementPolicies{
+        {"none", memstress::PlacementPolicy::None},
+        {"core", memstress::PlacementPolicy::Core},
+        {"smt", memstress::PlacementPolicy::Smt},
+        {"llc", memstress::PlacementPolicy::Llc},
+        {"compact", memstress::PlacementPolicy::Compact},
+        {"scatter", memstress::PlacementPolicy::Scatter}};
+    std::string placementPolicy{"none"};
+    app.add_option("--placement", placementPolicy, "Posicionamento das threads: none, core (uma por núcleo), smt (pares nos irmãos SMT), llc (uma por última cache), compact ou scatter")
+        ->check(CLI::IsMember(placementPolicies));
 
-long long calculateBufferSize(int percentLimit)
-{
-    long long totalAvailablePhysicalMem = getTotalAvailableVirtualMemory();
-    return (totalAvailablePhysicalMem * percentLimit) / 100;
-}
+    app.add_option("--perc", config.percentLimit, "Percentage limit of memory use");
 
-// Thread que inverte o valor binario da posicao
-void invertBinaryValueThread(std::chrono::time_point<std::chrono::steady_clock> finishTime, long long bufferSize)
-{
-    std::random_device randomDevice;
-    std::mt19937_64 memPositionGenerator(randomDevice());
-    std::uniform_int_distribution<long long> memPositionDistribution(0, bufferSize - 1);
+    int minutesToRun{1};
+    app.add_option("--min", minutesToRun, "Minutes to run");
 
-    while (finishTime > std::chrono::steady_clock::now())
-    {
-        std::lock_guard<std::mutex> guard(bufferMutex);
+    app.add_flag("--lock", config.lockMemory, "Trava o buffer na RAM (mlock) para evitar que vá para o swap");
 
-        long long memoryPosition = memPositionDistribution(memPositionGenerator);
+    std::map<std::string, memstress::PrefaultMode> prefaultModes{
+        {"none", memstress::PrefaultMode::None},
+        {"populate", memstress::PrefaultMode::Populate},
+        {"madvise", memstress::PrefaultMode::Madvise},
+        {"touch", memstress::PrefaultMode::Touch}};
+    std::string prefaultMode{"none"};
+    app.add_option("--prefault", prefaultMode, "Etapa de page fault antes do preenchimento: none, populate (MAP_POPULATE), madvise (MADV_POPULATE_WRITE) ou touch")
+        ->check(CLI::IsMember(prefaultModes));
 
-        if (memoryPosition >= bufferSize) continue;
+    std::map<std::string, memstress::BufferBackend> bufferBackends{
+        {"anonymous", memstress::BufferBackend::Anonymous},
+        {"memfd", memstress::BufferBackend::Memfd},
+        {"file", memstress::BufferBackend::File},
+        {"dax", memstress::BufferBackend::Dax}};
+    std::string bufferBackend{"anonymous"};
+    app.add_option("--backend", bufferBackend, "Origem do buffer: anonymous (memória do processo), memfd (memória compartilhada), file (arquivo em tmpfs/hugetlbfs) ou dax (arquivo em memória persistente com DAX)")
+        ->check(CLI::IsMember(bufferBackends));
 
-        char oldData = buffer[memoryPosition];
+    app.add_option("--backend-path", config.backendPath, "Arquivo do buffer nos backends file e dax, criado e removido se não existir; o conteúdo é sobrescrito");
 
-        // Operador ~ inverte o valor binario
-        buffer[memoryPosition] = ~buffer[memoryPosition];
+    std::map<std::string, memstress::QuarantineMode> quarantineModes{
+        {"none", memstress::QuarantineMode::None},
+        {"skip", memstress::QuarantineMode::Skip},
+        {"soft-offline", memstress::QuarantineMode::SoftOffline},
+        {"hwpoison", memstress::QuarantineMode::Poison}};
+    std::string quarantineMode{"none"};
+    app.add_option("--quarantine", quarantineMode, "Página com falha: none, skip (deixa de ser sorteada), soft-offline ou hwpoison (também aposenta o frame, requer root)")
+        ->check(CLI::IsMember(quarantineModes));
+
+    std::map<std::string, memstress::KernelIsa> kernelIsas{
+        {"auto", memstress::KernelIsa::Auto},
+        {"generic", memstress::KernelIsa::Generic},
+        {"sse2", memstress::KernelIsa::Sse2},
+        {"avx2", memstress::KernelIsa::Avx2},
+        {"avx512", memstress::KernelIsa::Avx512}};
+    std::string kernelIsa{"auto"};
+    app.add_option("--isa", kernelIsa, "Conjunto de instruções máximo dos kernels: auto, generic, sse2, avx2 ou avx512")
+        ->check(CLI::IsMember(kernelIsas));
+
+    bool rampMode{false};
+    auto rampOption = app.add_flag("--ramp", rampMode, "Modo rampa: mede banda e latência aumentando o conjunto de trabalho de 32 KiB até o buffer inteiro");
+
+    bool scalingMode{false};
+    auto scalingOption = app.add_flag("--scaling-sweep", scalingMode, "Modo varredura: mede a banda de cada kernel e as operações aleatórias com 1, 2, 4... threads até todas as CPUs, por nó NUMA, e mostra o ponto de saturação");
+
+    std::vector<std::string> scalingKernels = memstress::scalingKernelNames();
+    app.add_option("--scaling-kernels", scalingKernels, "Kernels de blocos medidos na varredura: fill, verify, invert e swap")
+        ->check(CLI::IsMember(memstress::scalingKernelNames()));
+
+    bool interleaveMode{false};
+    auto interleaveOption = app.add_flag("--interleave", interleaveMode, "Modo interleave: descobre os bits de canal, banco e linha pelo tempo de acesso e mede a banda de cada canal");
 
-        std::cout
-            << "Posição " << memoryPosition << " inverteu os bits.\r"
-            << std::flush;
+    long long sizeMiB{0};
+    app.add_option("--size-mb", sizeMiB, "Tamanho fixo do buffer em MiB, substitui o --perc");
+
+    auto targetGbpsOption = app.add_option("--target-gbps", config.targetGbps, "Modo pressão: banda de memória alvo em GB/s, gerada em ritmo controlado");
+
+    auto targetOpsOption = app.add_option("--target-ops", config.targetOps, "Modo pressão: operações aleatórias por segundo alvo, geradas em ritmo controlado");
+
+    targetGbpsOption->excludes(targetOpsOption);
+
+    app.add_option("--report-interval", config.reportSeconds, "Intervalo em segundos dos relatórios periódicos")
+        ->check(CLI::PositiveNumber);
+
+    app.add_option("--metrics-file", config.metricsFile, "Escreve as métricas do estresse no formato do Prometheus neste arquivo a cada relatório (textfile collector do node_exporter, use a extensão .prom)");
+
+    app.add_option("--metrics-port", config.metricsPort, "Serve as métricas do estresse no formato do Prometheus por HTTP nesta porta")
+        ->check(CLI::Range(1, 65535));
+
+    auto checkpointOption = app.add_option("--checkpoint", config.checkpointFile, "Grava o estado do estresse neste arquivo periodicamente e ao receber Ctrl+C/SIGTERM, para continuar com --resume");
+
+    app.add_option("--checkpoint-interval", config.checkpointSeconds, "Intervalo em segundos entre os checkpoints")
+        ->check(CLI::PositiveNumber);
+
+    bool resume{false};
+    app.add_flag("--resume", resume, "Continua o estresse do arquivo de --checkpoint: aloca e preenche o mesmo buffer e segue pelo tempo que faltava")
+        ->needs(checkpointOption);
+
+    auto seedOption = app.add_option("--seed", config.seed, "Semente das posições aleatórias: cada thread usa uma sequência derivada dela, repetindo a execução; as falhas mostram a sequência para o --replay-from")
+        ->check(CLI::PositiveNumber);
+
+    auto replayOption = app.add_option("--replay-thread", config.replayThread, "Modo replay: reexecuta a sequência de operações desta thread do estresse original (mesmos --seed, --size-mb e --threads)")
+        ->check(CLI::NonNegativeNumber)
+        ->needs(seedOption);
+
+    app.add_option("--replay-from", config.replayFrom, "Modo replay: posição da sequência onde começar, a sequência mostrada na falha")
+        ->needs(replayOption);
+
+    app.add_option("--replay-count", config.replayCount, "Modo replay: operações da janela repetida até o fim do --min, 0 segue a sequência sem repetir")
+        ->check(CLI::NonNegativeNumber)
+        ->needs(replayOption);
+
+    auto traceOption = app.add_option("--trace", config.traceFile, "Grava as operações de cada thread do estresse ou do replay (posições, valores, lotes e falhas) neste arquivo binário, leia com mem-stress-trace");
+
+    long long traceMaxMiB{1024};
+    app.add_option("--trace-max-mb", traceMaxMiB, "Tamanho máximo do arquivo de trace em MiB, 0 sem limite; os lotes seguintes são só contados")
+        ->check(CLI::NonNegativeNumber)
+        ->needs(traceOption);
+
+    auto processesOption = app.add_option("--processes", config.processes, "Estresse padrão em N processos, cada um com a sua fatia do buffer e das threads: contorna limites por processo e a queda de um não derruba os outros")
+        ->check(CLI::PositiveNumber)
+        ->excludes(checkpointOption)
+        ->excludes(replayOption)
+        ->excludes(traceOption);
+
+    bool mixedMode{false};
+    auto mixedOption = app.add_flag("--mixed", mixedMode, "Modo misto: leituras e escritas conferidas na proporção, padrão e largura pedidos, para se parecer com a carga de uma aplicação (banco de dados, cache)");
 
-        if (buffer[memoryPosition] != ~oldData)
-        {
-            errCounter++;
-        }
-    }
-}
+    app.add_option("--read-percent", config.mixed.readPercent, "Modo misto: porcentagem das operações que só leem, o resto escreve")
+        ->check(CLI::Range(0, 100))
+        ->needs(mixedOption);
 
-// Thread que faz o swap do valor de duas posicoes
-void swapValuesThread(std::chrono::time_point<std::chrono::steady_clock> finishTime, long long bufferSize)
-{
-    std::random_device randomDevice;
-    std::mt19937_64 memPositionGenerator(randomDevice());
-    std::uniform_int_distribution<long long> memPositionDistribution(0, bufferSize - 1);
+    std::map<std::string, memstress::AccessPattern> accessPatterns{
+        {"random", memstress::AccessPattern::Random},
+        {"sequential", memstress::AccessPattern::Sequential},
+        {"strided", memstress::AccessPattern::Strided},
+        {"zipfian", memstress::AccessPattern::Zipfian}};
+    std::string accessPattern{"random"};
+    app.add_option("--access-pattern", accessPattern, "Modo misto: random, sequential, strided (saltos de --stride-bytes) ou zipfian (poucas posições quentes concentram os acessos)")
+        ->check(CLI::IsMember(accessPatterns))
+        ->needs(mixedOption);
 
-    while (finishTime > std::chrono::steady_clock::now())
-    {
-        std::lock_guard<std::mutex> guard(bufferMutex);
+    app.add_option("--access-width", config.mixed.width, "Modo misto: bytes de cada leitura ou escrita: 8, 16, 32 ou 64")
+        ->check(CLI::IsMember({8, 16, 32, 64}))
+        ->needs(mixedOption);
 
-        long long firstMemoryPosition = memPositionDistribution(memPositionGenerator);
-        long long secondMemoryPosition = memPositionDistribution(memPositionGenerator);
+    app.add_option("--stride-bytes", config.mixed.stride, "Modo misto: salto em bytes do padrão strided")
+        ->check(CLI::PositiveNumber)
+        ->needs(mixedOption);
 
-        if (firstMemoryPosition >= bufferSize || secondMemoryPosition >= bufferSize) continue;
+    app.add_option("--zipf-theta", config.mixed.zipfTheta, "Modo misto: inclinação do padrão zipfian, maior concentra mais os acessos (0.99 como no YCSB)")
+        ->check(CLI::Range(0.01, 0.999))
+        ->needs(mixedOption);
 
-        char firstDataInMemory = buffer[firstMemoryPosition];
-        char secondDataInMemory = buffer[secondMemoryPosition];
+    std::map<std::string, memstress::ChurnMethod> churnMethods{
+        {"malloc", memstress::ChurnMethod::Malloc},
+        {"mmap", memstress::ChurnMethod::Mmap},
+        {"madvise", memstress::ChurnMethod::Madvise}};
+    std::string churnMethod;
+    auto churnOption = app.add_option("--churn", churnMethod, "Modo churn: aloca, toca e libera blocos continuamente via malloc, mmap (mmap/munmap) ou madvise (MADV_DONTNEED)")
+        ->check(CLI::IsMember(churnMethods));
 
-        // Operador ~ inverte o valor binario
-        buffer[firstMemoryPosition] = secondDataInMemory;
-        buffer[secondMemoryPosition] = firstDataInMemory;
+    app.add_option("--churn-rate", config.churnRate, "Alocações por segundo do modo churn somando todas as threads, 0 para sem limite");
 
-        std::cout
-            << "Posição " << firstMemoryPosition
-            << " trocou de valor com " << secondMemoryPosition << ".\r"
-            << std::flush;
+    long long churnMaxKiB{16 * 1024};
+    app.add_option("--churn-max-kb", churnMaxKiB, "Tamanho máximo em KiB dos blocos do modo churn")
+        ->check(CLI::Range(4LL, 1024LL * 1024 * 1024));
 
-        if (buffer[firstMemoryPosition] != secondDataInMemory || buffer[secondMemoryPosition] != firstDataInMemory)
-        {
-            errCounter++;
-        }
-    }
-}
+    // Um modo por execucao, combinar as opcoes de dois modos eh erro em vez de rodar so um deles
+    std::vector<CLI::Option *> modeOptions{replayOption, churnOption, rampOption, interleaveOption, scalingOption,
+        mixedOption, targetGbpsOption, targetOpsOption};
 
-// Preenche parte do buffer com o padrao, nao usa mutex pois a posicao eh fixa
-void writePattern(long long startIndex, long long finalIndex)
-{
-    for (long long i = startIndex; i < finalIndex; i++)
+    for (size_t i = 0; i < modeOptions.size(); i++)
     {
-        buffer[i] = i % 2 == 0 ? 0x55 : 0xAA;
+        for (size_t j = i + 1; j < modeOptions.size(); j++) modeOptions[i]->excludes(modeOptions[j]);
     }
-}
 
-// Chamada para preecher buffer
-void fillBuffer(long long bufferSize, int qtyThreads)
-{
-    std::vector<std::thread> threads;
+    // O multiprocesso so existe no estresse padrao
+    for (CLI::Option * modeOption : modeOptions) processesOption->excludes(modeOption);
 
-    long long sizeToFill = bufferSize / (qtyThreads * 2);
+    CLI11_PARSE(app, argc, argv);
 
-    for (int i = 0; i < qtyThreads * 2; i++)
+    config.duration = std::chrono::minutes(minutesToRun);
+    config.sizeBytes = sizeMiB * 1024 * 1024;
+    config.prefault = prefaultModes[prefaultMode];
+    config.backend = bufferBackends[bufferBackend];
+    config.kernelIsa = kernelIsas[kernelIsa];
+    config.quarantine = quarantineModes[quarantineMode];
+    config.placement = placementPolicies[placementPolicy];
+    config.churnMaxChunkSize = churnMaxKiB * 1024;
+    config.traceMaxBytes = traceMaxMiB * 1024 * 1024;
+    config.mixed.pattern = accessPatterns[accessPattern];
+
+    if ((config.backend == memstress::BufferBackend::File || config.backend == memstress::BufferBackend::Dax) && config.backendPath.empty())
     {
-        long long startIndex = i * sizeToFill;
-
-        // Se for a ultima thread, preenche ate o final
-        long long finalIndex = i == (qtyThreads * 2 - 1)
-            ? bufferSize
-            :  (i + 1) * sizeToFill;
-
-        threads.push_back(std::thread(writePattern, startIndex, finalIndex));
+        std::cerr << "--backend " << bufferBackend << " precisa do --backend-path" << std::endl;
+        return 1;
     }
 
-    // Impede que o programa feche antes das threads finalizarem
-    for (auto& thread : threads) {
-        thread.join();
+    if (replayOption->count() > 0)
+    {
+        config.mode = memstress::StressMode::Replay;
+    }
+    else if (!churnMethod.empty())
+    {
+        config.mode = memstress::StressMode::Churn;
+        config.churnMethod = churnMethods[churnMethod];
+    }
+    else if (rampMode)
+    {
+        config.mode = memstress::StressMode::Ramp;
+    }
+    else if (interleaveMode)
+    {
+        config.mode = memstress::StressMode::Interleave;
+    }
+    else if (scalingMode)
+    {
+        config.mode = memstress::StressMode::Scaling;
+        config.scalingKernels = scalingKernels;
+    }
+    else if (mixedMode)
+    {
+        config.mode = memstress::StressMode::Mixed;
+    }
+    else if (config.targetGbps > 0 || config.targetOps > 0)
+    {
+        config.mode = memstress::StressMode::Pressure;
     }
-}
-
-int main(int argc, char **argv)
-{
-    // inicializa o CLI11, lib para passar parametros no executavel
-    CLI::App app;
 
-    int qtyThreads{4};
-    app.add_option("--threads", qtyThreads, "Quantidade de threads para estressar a memória");
+    std::cout << "Inicializando estressador de memória!" << std::endl;
+    std::cout << "Posicionamento das threads: " << placementPolicy << std::endl;
+    std::cout << "Limite de uso de memória (%): " << config.percentLimit << std::endl;
+    std::cout << "Tempo para executar (min): " << minutesToRun << std::endl;
+    std::cout << "Trava de memória: " << (config.lockMemory ? "sim" : "não") << std::endl;
+    std::cout << "Pré-falta de páginas: " << prefaultMode << std::endl;
+    std::cout << "Origem do buffer: " << bufferBackend << (config.backendPath.empty() ? "" : " (" + config.backendPath + ")") << "\n" << std::endl;
+
+    if (config.lockMemory && config.mode != memstress::StressMode::Churn)
+    {
+        std::cout << "Limite RLIMIT_MEMLOCK (soft/hard): " << memstress::describeMemlockLimit() << std::endl;
+    }
 
-    int percentLimit{60};
-    app.add_option("--perc", percentLimit, "Percentage limit of memory use");
+    memstress::StressSession session(config);
+    session.setOutput(&std::cout);
 
-    int minutesToRun{1};
-    app.add_option("--min", minutesToRun, "Minutes to run");
+    if (resume)
+    {
+        memstress::StressCheckpoint checkpoint;
+        std::string error = memstress::loadCheckpoint(config.checkpointFile, checkpoint);
 
-    CLI11_PARSE(app, argc, argv);
+        if (error.empty()) error = session.resumeFrom(checkpoint);
 
-    std::cout << "Inicializando estressador de memória!" << std::endl;
-    std::cout << "Threads rodando: " << qtyThreads << std::endl;
-    std::cout << "Limite de uso de memória (%): " << percentLimit << std::endl;
-    std::cout << "Tempo para executar (min): " << minutesToRun << "\n" << std::endl;
+        if (!error.empty())
+        {
+            std::cerr << "Não foi possível continuar do checkpoint: " << error << std::endl;
+            return 1;
+        }
+    }
 
-    long long bufferSize = calculateBufferSize(percentLimit);
+    if (!config.checkpointFile.empty())
+    {
+        activeSession = &session;
+        std::signal(SIGINT, requestStop);
+        std::signal(SIGTERM, requestStop);
+    }
 
     try
     {
-        std::cout << "Preenchendo o buffer de memória... " << std::flush;
-
-        buffer = new char[bufferSize];
-        fillBuffer(bufferSize, qtyThreads);
-
-        std::cout << "Memória preenchida!\n" << std::endl;
+        session.run();
     }
     catch (const std::bad_alloc& e)
     {
@@ -189,30 +308,90 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    std::chrono::time_point finishTime = std::chrono::steady_clock::now() + std::chrono::minutes(minutesToRun);
+    const memstress::StressResults& results = session.results();
 
-    std::vector<std::thread> threads;
+    if (!results.bufferError.empty()) return 1;
 
-    // Aloca 2 threads por nucleo
-    for (int i = 0; i < qtyThreads * 2; i++)
+    switch (config.mode)
     {
-        if (i % 2 == 0)
+        case memstress::StressMode::Pressure:
         {
-            threads.push_back(std::thread(invertBinaryValueThread, finishTime, bufferSize));
-        } else {
-            threads.push_back(std::thread(swapValuesThread, finishTime, bufferSize));
+            double scale = results.pressure.bandwidthMode ? 1e9 : 1;
+            const char * unit = results.pressure.bandwidthMode ? " GB/s" : " ops/s";
+
+            std::cout << "Média obtida: " << results.pressure.achieved / scale << unit << std::endl;
+            break;
         }
-    }
 
-    // Impede que o programa feche antes das threads finalizarem
-    for (auto& thread : threads) {
-        thread.join();
+        case memstress::StressMode::Churn:
+            std::cout << "Total de alocações: " << results.churn.allocations << std::endl;
+            std::cout << "Page faults/s médio: " << static_cast<long long>(results.churn.pageFaultsPerSecond) << std::endl;
+            std::cout << "Latência de alocação média / máxima (us): "
+                << results.churn.meanAllocationUs << " / " << results.churn.maxAllocationUs << std::endl;
+            break;
+
+        case memstress::StressMode::Interleave:
+        {
+            long long slowChannels = 0;
+
+            for (const auto& channel : results.interleave.channels) slowChannels += channel.slow;
+
+            if (results.interleave.available) std::cout << "Canais lentos: " << slowChannels << std::endl;
+            break;
+        }
+
+        case memstress::StressMode::Scaling:
+            // A ultima curva eh a da maquina inteira
+            if (!results.scaling.curves.empty() && !results.scaling.kernels.empty())
+            {
+                const memstress::ScalingCurve& machine = results.scaling.curves.back();
+
+                std::cout << "Saturação de " << results.scaling.kernels.front() << ": " << machine.saturationThreads.front()
+                    << " threads (" << machine.peakGbps.front() << " GB/s)" << std::endl;
+            }
+            break;
+
+        case memstress::StressMode::Mixed:
+            std::cout << "Leituras / escritas: " << results.mixed.reads << " / " << results.mixed.writes << std::endl;
+            std::cout << "Média obtida: " << static_cast<long long>(results.mixed.opsPerSecond) << " ops/s, "
+                << results.mixed.gbps << " GB/s" << std::endl;
+            std::cout << "Quantidade detectada de erros de memória: " << results.mixed.errors << std::endl;
+            break;
+
+        case memstress::StressMode::Replay:
+            std::cout << "Operações reexecutadas: " << results.replay.operations
+                << " (" << results.replay.passes << " passagens completas pela janela)" << std::endl;
+            std::cout << "Quantidade detectada de erros de memória: " << results.replay.errors << std::endl;
+            break;
+
+        case memstress::StressMode::Stress:
+            std::cout << "Operações realizadas: " << results.operations << std::endl;
+            std::cout << "Quantidade detectada de erros de memória: " << results.errors << std::endl;
+
+            if (config.quarantine != memstress::QuarantineMode::None)
+            {
+                std::cout << "Páginas isoladas: " << results.badPages.size() << std::endl;
+            }
+
+            if (!results.processes.empty())
+            {
+                long long failed = std::count_if(results.processes.begin(), results.processes.end(),
+                    [](const memstress::ProcessResult& process) { return process.failed; });
+
+                std::cout << "Processos que falharam: " << failed << " de " << results.processes.size() << std::endl;
+            }
+            break;
+
+        default:
+            break;
     }
 
-    delete[] buffer;
+    // O estresse e o replay sobrevivem ao SIGBUS de uma pagina envenenada, a contagem vale para os dois
+    long long poisonedPages = std::count_if(results.badPages.begin(), results.badPages.end(),
+        [](const memstress::BadPage& page) { return page.sigbus; });
+
+    if (poisonedPages > 0) std::cout << "Páginas com SIGBUS recuperadas: " << poisonedPages << std::endl;
 
-    std::cout << std::endl;
-    std::cout << "Quantidade detectada de erros de memória: " << errCounter << std::endl;
     std::cout << "Programa finalizado" << std::endl;
 
     return 0;
@@ -0,0 +1,289 @@
+#include "memstress/buffer.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <vector>
+#include "memstress/cpu.hpp"
+#include "memstress/kernels.hpp"
+#include "memstress/parallel.hpp"
+#include "memstress/system.hpp"
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/statfs.h>
+    #include <unistd.h>
+
+    // Disponivel a partir do Linux 5.14, definido aqui para compilar com cabecalhos antigos
+    #ifndef MADV_POPULATE_WRITE
+        #define MADV_POPULATE_WRITE 23
+    #endif
+
+    // Disponiveis a partir do Linux 4.15
+    #ifndef MAP_SHARED_VALIDATE
+        #define MAP_SHARED_VALIDATE 0x03
+    #endif
+
+    #ifndef MAP_SYNC
+        #define MAP_SYNC 0x80000
+    #endif
+#endif
+
+namespace memstress
+{
+
+#ifdef __linux__
+
+namespace
+{
+
+// Abre o arquivo do backend e deixa o tamanho reservado. O fallocate reserva os blocos agora: num tmpfs
+// cheio o erro aparece aqui, e nao como SIGBUS no meio do preenchimento. Retorna -1 com o motivo em error.
+int openBackingFile(BufferBackend backend, const std::string& path, long long& size, std::string& error)
+{
+    std::string name = backend == BufferBackend::Memfd ? "memfd" : path;
+    int fd = -1;
+
+    if (backend == BufferBackend::Memfd)
+    {
+        fd = memfd_create("mem-stress", MFD_CLOEXEC);
+        if (fd < 0) error = name + ": " + std::strerror(errno);
+    } else {
+        // O arquivo criado aqui sai do diretorio logo depois do mapeamento, so o mapeamento o mantem
+        fd = open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+
+        if (fd >= 0)
+        {
+            unlink(path.c_str());
+        }
+        else if (errno == EEXIST)
+        {
+            fd = open(path.c_str(), O_RDWR | O_CLOEXEC);
+        }
+
+        if (fd < 0) error = path + ": " + std::strerror(errno);
+    }
+
+    if (fd < 0) return -1;
+
+    // No hugetlbfs o bloco eh a pagina enorme, e o mapeamento precisa de um multiplo dela
+    struct statfs filesystem;
+
+    if (fstatfs(fd, &filesystem) == 0 && filesystem.f_bsize > 0)
+    {
+        long long block = filesystem.f_bsize;
+        size = (size + block - 1) / block * block;
+    }
+
+    struct stat status;
+
+    if (fstat(fd, &status) == 0 && status.st_size < size && ftruncate(fd, size) != 0)
+    {
+        error = name + ": ftruncate: " + std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+
+    int result = fallocate(fd, 0, 0, size);
+
+    if (result != 0 && errno != EOPNOTSUPP)
+    {
+        error = name + ": fallocate: " + std::strerror(errno);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+} // namespace
+
+#endif
+
+Buffer::Buffer(long long size, bool lockMemory, PrefaultMode prefault, BufferBackend backend, const std::string& path)
+    : memory(nullptr), bufferSize(size), prefaultMode(prefault), bufferBackend(backend), isLocked(false)
+{
+    #ifdef __linux__
+        // Com populate o kernel ja cria todas as paginas na alocacao
+        int populate = prefault == PrefaultMode::Populate ? MAP_POPULATE : 0;
+        void * mapping = MAP_FAILED;
+
+        if (backend == BufferBackend::Anonymous)
+        {
+            mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | populate, -1, 0);
+
+            if (mapping == MAP_FAILED) throw std::bad_alloc();
+        } else {
+            int fd = openBackingFile(backend, path, bufferSize, mapFailure);
+
+            if (fd < 0)
+            {
+                bufferSize = 0;
+                return;
+            }
+
+            // MAP_SHARED_VALIDATE recusa o MAP_SYNC fora de um DAX em vez de ignorar a flag
+            int flags = backend == BufferBackend::Dax ? MAP_SHARED_VALIDATE | MAP_SYNC : MAP_SHARED;
+
+            mapping = mmap(nullptr, bufferSize, PROT_READ | PROT_WRITE, flags | populate, fd, 0);
+            int mapError = errno;
+            close(fd);
+
+            if (mapping == MAP_FAILED)
+            {
+                mapFailure = backend == BufferBackend::Dax && mapError == EOPNOTSUPP
+                    ? path + ": o arquivo não está em um sistema de arquivos montado com DAX"
+                    : "mmap: " + std::string(std::strerror(mapError));
+                bufferSize = 0;
+                return;
+            }
+        }
+
+        memory = static_cast<char *>(mapping);
+        size = bufferSize;
+
+        if (!lockMemory) return;
+
+        // mlock em vez de MAP_LOCKED: o mmap nao falha quando nao consegue popular as paginas travadas
+        if (mlock(mapping, size) != 0)
+        {
+            lockFailure = std::strerror(errno);
+            return;
+        }
+
+        isLocked = true;
+    #else
+        if (backend != BufferBackend::Anonymous)
+        {
+            mapFailure = "buffer em arquivo ou memfd disponível apenas no Linux";
+            bufferSize = 0;
+            return;
+        }
+
+        memory = new char[size];
+
+        if (lockMemory)
+        {
+            lockFailure = "trava de memória não suportada nesta plataforma";
+        }
+    #endif
+}
+
+Buffer::~Buffer()
+{
+    #ifdef __linux__
+        if (memory) munmap(const_cast<char *>(memory), bufferSize);
+    #else
+        delete[] memory;
+    #endif
+}
+
+void Buffer::adviseHugePages()
+{
+    #ifdef __linux__
+        madvise(const_cast<char *>(memory), bufferSize, MADV_HUGEPAGE);
+    #endif
+}
+
+void Buffer::prefault(int threadCount, const std::vector<int>& placement)
+{
+    if (prefaultMode != PrefaultMode::Madvise && prefaultMode != PrefaultMode::Touch) return;
+
+    const long long pageSize = getPageSize();
+
+    // Cada thread cuida de uma faixa alinhada em paginas
+    runParallel(threadCount, [&](int index) {
+        Range range = partitionRange(bufferSize, threadCount, index, pageSize);
+
+        if (range.startIndex >= range.finalIndex) return;
+
+        #ifdef __linux__
+            // Sem suporte no kernel (EINVAL) cai para o toque manual das paginas
+            if (prefaultMode == PrefaultMode::Madvise
+                && madvise(const_cast<char *>(memory) + range.startIndex, range.finalIndex - range.startIndex, MADV_POPULATE_WRITE) == 0) return;
+        #endif
+
+        // Toca uma posicao por pagina para forcar o page fault antes do preenchimento
+        for (long long i = range.startIndex; i < range.finalIndex; i += pageSize)
+        {
+            memory[i] = 0;
+        }
+    }, placement);
+}
+
+void Buffer::fill(int threadCount, const std::vector<int>& placement)
+{
+    // Buffers bem maiores que a ultima cache sao preenchidos com escritas non-temporal, que nao leem
+    // a linha antes de escrever nem expulsam o resto da cache
+    long long cacheSize = cpuFeatures().lastLevelCacheSize;
+    bool streaming = bufferSize > 2 * (cacheSize > 0 ? cacheSize : 32LL * 1024 * 1024);
+
+    // Nao usa mutex pois cada thread tem a sua faixa fixa
+    runParallel(threadCount, [&](int index) {
+        Range range = partitionRange(bufferSize, threadCount, index, cpuFeatures().cacheLineSize);
+
+        if (streaming)
+        {
+            fillPatternStreaming(const_cast<char *>(memory), range.startIndex, range.finalIndex);
+        } else {
+            fillPattern(const_cast<char *>(memory), range.startIndex, range.finalIndex);
+        }
+    }, placement);
+}
+
+std::string Buffer::refill(int threadCount, const std::vector<int>& placement)
+{
+    // Nos backends de arquivo as paginas sao do page cache (ou do dispositivo) e continuam la
+    if (bufferBackend != BufferBackend::Anonymous) return "as páginas de um backend de arquivo não são realocadas";
+
+    // Paginas travadas nao podem ser descartadas
+    if (isLocked) return "buffer travado na RAM";
+
+    #ifdef __linux__
+        if (madvise(const_cast<char *>(memory), bufferSize, MADV_DONTNEED) != 0) return std::strerror(errno);
+
+        fill(threadCount, placement);
+        return "";
+    #else
+        (void) threadCount;
+        (void) placement;
+        return "recolocação das páginas disponível apenas no Linux";
+    #endif
+}
+
+double Buffer::residency() const
+{
+    #ifdef __linux__
+        const long long pageSize = getPageSize();
+
+        // Consulta em blocos para nao alocar um vetor gigante em buffers de varios GB
+        const long long pagesPerChunk = 64 * 1024;
+        std::vector<unsigned char> pageStatus(pagesPerChunk);
+
+        long long totalPages = (bufferSize + pageSize - 1) / pageSize;
+        long long residentPages = 0;
+
+        for (long long page = 0; page < totalPages; page += pagesPerChunk)
+        {
+            long long pagesInChunk = std::min(pagesPerChunk, totalPages - page);
+            char * chunkStart = const_cast<char *>(memory) + page * pageSize;
+            long long chunkLength = std::min(pagesInChunk * pageSize, bufferSize - page * pageSize);
+
+            if (mincore(chunkStart, chunkLength, pageStatus.data()) != 0) return -1;
+
+            for (long long i = 0; i < pagesInChunk; i++)
+            {
+                residentPages += pageStatus[i] & 1;
+            }
+        }
+
+        return totalPages == 0 ? 100.0 : (residentPages * 100.0) / totalPages;
+    #else
+        return -1;
+    #endif
+}
+
+} // namespace memstress
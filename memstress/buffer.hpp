@@ -0,0 +1,80 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace memstress
+{
+
+// Etapa de page fault antes do preenchimento
+enum class PrefaultMode
+{
+    None,      // os page faults acontecem no preenchimento
+    Populate,  // MAP_POPULATE na alocacao
+    Madvise,   // MADV_POPULATE_WRITE em paralelo por thread
+    Touch      // toque de cada pagina em paralelo por thread
+};
+
+// De onde vem a memoria do buffer. Os kernels sao os mesmos em todos, so o mapeamento muda.
+enum class BufferBackend
+{
+    Anonymous,  // memoria anonima privada do processo
+    Memfd,      // memfd compartilhado (shmem), a mesma memoria dos segmentos compartilhados
+    File,       // arquivo em tmpfs ou hugetlbfs (page cache ou paginas enormes reservadas)
+    Dax         // arquivo em um sistema de arquivos DAX (memoria persistente), com MAP_SYNC
+};
+
+// Buffer de memoria estressado, alocado direto do sistema operacional.
+// Volatile para evitar que o compilador otimize a leitura/escrita.
+class Buffer
+{
+public:
+    // Lanca std::bad_alloc se a alocacao falhar. Se o travamento na RAM falhar o buffer continua
+    // valido sem trava e o motivo fica em lockError(). Nos backends de arquivo o caminho eh o arquivo
+    // usado (criado e removido se nao existir) e o tamanho sobe para o bloco do sistema de arquivos
+    // (a pagina enorme no hugetlbfs); sem o arquivo ou o mapeamento o motivo fica em error().
+    Buffer(long long size, bool lockMemory, PrefaultMode prefault, BufferBackend backend = BufferBackend::Anonymous,
+        const std::string& path = "");
+    ~Buffer();
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    volatile char * data() const { return memory; }
+    long long size() const { return bufferSize; }
+
+    bool locked() const { return isLocked; }
+    const std::string& lockError() const { return lockFailure; }
+
+    // Vazio se o buffer foi mapeado; com erro o buffer fica vazio e nao deve ser usado
+    const std::string& error() const { return mapFailure; }
+
+    // Pede paginas enormes (THP) ao kernel, deve ser chamado antes do primeiro toque nas paginas
+    void adviseHugePages();
+
+    // Faz o page fault de todas as paginas em paralelo (modos Madvise e Touch), com as threads presas nas
+    // CPUs de placement (vazio para nao prender), assim o primeiro toque ja acontece no no NUMA delas
+    void prefault(int threadCount, const std::vector<int>& placement = {});
+
+    // Preenche o buffer com o padrao alternado em paralelo, as threads presas como no prefault
+    void fill(int threadCount, const std::vector<int>& placement = {});
+
+    // Devolve as paginas ao kernel e preenche de novo em paralelo, assim o primeiro toque das threads presas
+    // nas CPUs de placement coloca cada pagina no no NUMA delas. So na memoria anonima sem trava, nos outros
+    // casos as paginas ficam onde estao; retorna o motivo, vazio se o buffer foi recolocado.
+    std::string refill(int threadCount, const std::vector<int>& placement);
+
+    // Porcentagem das paginas que estao na RAM (mincore), -1 se nao for possivel medir
+    double residency() const;
+
+private:
+    volatile char * memory;
+    long long bufferSize;
+    PrefaultMode prefaultMode;
+    BufferBackend bufferBackend;
+    bool isLocked;
+    std::string lockFailure;
+    std::string mapFailure;
+};
+
+} // namespace memstress
@@ -0,0 +1,185 @@
+#include "memstress/checkpoint.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace memstress
+{
+
+namespace
+{
+
+// Primeira linha do arquivo, muda quando o formato mudar
+const std::string checkpointHeader = "memstress-checkpoint 3";
+
+// Resto da linha depois dos campos ja lidos, sem o espaco separador
+std::string restOfLine(std::istream& line)
+{
+    std::string rest;
+    std::getline(line >> std::ws, rest);
+    return rest;
+}
+
+} // namespace
+
+// Formato em texto, uma informacao por linha:
+//   phase/buffer/duration/elapsed/threads <valor>
+//   thread <indice> <operacoes> <lidos> <escritos> <erros> <latencia max.> <paginas isoladas> <soma das latencias> <faixas...>
+//   generator <indice> <semente> <posicao na sequencia>
+//   fault <thread> <posicao> <endereco virtual> <endereco fisico> <segundos> <sequencia>
+//   page <thread> <posicao> <endereco virtual> <endereco fisico> <segundos> <sigbus 0/1> <acao>
+std::string saveCheckpoint(const std::string& path, const StressCheckpoint& checkpoint)
+{
+    std::string temporaryPath = path + ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+
+        file.precision(17);
+        file << checkpointHeader << "\n";
+        file << "phase " << checkpoint.phase << "\n";
+        file << "buffer " << checkpoint.bufferSize << "\n";
+        file << "duration " << checkpoint.durationSeconds << "\n";
+        file << "elapsed " << checkpoint.elapsedSeconds << "\n";
+        file << "threads " << checkpoint.threads.size() << "\n";
+
+        for (size_t i = 0; i < checkpoint.threads.size(); i++)
+        {
+            const ThreadCheckpoint& thread = checkpoint.threads[i];
+
+            file << "thread " << i << " " << thread.operations << " " << thread.bytesRead << " " << thread.bytesWritten
+                << " " << thread.errors << " " << thread.maxLatencyNanos << " " << thread.quarantinedPages
+                << " " << thread.latencySumNanos;
+
+            for (long long bucket : thread.latencyBuckets) file << " " << bucket;
+            file << "\n";
+
+            if (!thread.generatorState.empty()) file << "generator " << i << " " << thread.generatorState << "\n";
+
+            for (const FaultRecord& fault : thread.faults)
+            {
+                file << "fault " << fault.thread << " " << fault.offset << " " << fault.virtualAddress << " "
+                    << fault.physicalAddress << " " << fault.seconds << " " << fault.sequence << "\n";
+            }
+
+            for (const BadPage& page : thread.badPages)
+            {
+                file << "page " << page.thread << " " << page.offset << " " << page.virtualAddress << " "
+                    << page.physicalAddress << " " << page.seconds << " " << page.sigbus << " " << page.action << "\n";
+            }
+        }
+
+        file.flush();
+        if (!file) return temporaryPath + ": " + std::strerror(errno);
+    }
+
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) return path + ": " + std::strerror(errno);
+
+    return "";
+}
+
+std::string loadCheckpoint(const std::string& path, StressCheckpoint& checkpoint)
+{
+    std::ifstream file(path);
+    if (!file) return path + ": " + std::strerror(errno);
+
+    std::string text;
+    std::getline(file, text);
+    if (text != checkpointHeader) return path + ": não é um checkpoint do mem-stress ou é de outra versão";
+
+    checkpoint = StressCheckpoint();
+    int lineNumber = 1;
+
+    while (std::getline(file, text))
+    {
+        lineNumber++;
+
+        std::istringstream line(text);
+        std::string key;
+        line >> key;
+
+        // Indice de thread de uma linha, que precisa vir depois da linha "threads"
+        auto threadAt = [&](long long index) -> ThreadCheckpoint * {
+            if (index < 0 || index >= static_cast<long long>(checkpoint.threads.size())) return nullptr;
+            return &checkpoint.threads[index];
+        };
+
+        long long index = -1;
+        bool ok = true;
+
+        if (key.empty())
+        {
+            continue;
+        }
+        else if (key == "phase")
+        {
+            ok = static_cast<bool>(line >> checkpoint.phase);
+        }
+        else if (key == "buffer")
+        {
+            ok = static_cast<bool>(line >> checkpoint.bufferSize);
+        }
+        else if (key == "duration")
+        {
+            ok = static_cast<bool>(line >> checkpoint.durationSeconds);
+        }
+        else if (key == "elapsed")
+        {
+            ok = static_cast<bool>(line >> checkpoint.elapsedSeconds);
+        }
+        else if (key == "threads")
+        {
+            ok = static_cast<bool>(line >> index) && index > 0;
+            if (ok) checkpoint.threads.assign(index, ThreadCheckpoint());
+        }
+        else if (key == "thread")
+        {
+            ThreadCheckpoint * thread = (line >> index) ? threadAt(index) : nullptr;
+
+            ok = thread && line >> thread->operations >> thread->bytesRead >> thread->bytesWritten >> thread->errors
+                >> thread->maxLatencyNanos >> thread->quarantinedPages >> thread->latencySumNanos;
+
+            long long bucket = 0;
+
+            while (ok && line >> bucket) thread->latencyBuckets.push_back(bucket);
+        }
+        else if (key == "generator")
+        {
+            ThreadCheckpoint * thread = (line >> index) ? threadAt(index) : nullptr;
+
+            ok = thread != nullptr;
+            if (ok) thread->generatorState = restOfLine(line);
+        }
+        else if (key == "fault")
+        {
+            FaultRecord fault;
+            ok = line >> fault.thread >> fault.offset >> fault.virtualAddress >> fault.physicalAddress >> fault.seconds
+                >> fault.sequence && threadAt(fault.thread);
+
+            if (ok) threadAt(fault.thread)->faults.push_back(fault);
+        }
+        else if (key == "page")
+        {
+            BadPage page;
+            ok = line >> page.thread >> page.offset >> page.virtualAddress >> page.physicalAddress >> page.seconds
+                >> page.sigbus && threadAt(page.thread);
+
+            if (ok)
+            {
+                page.action = restOfLine(line);
+                threadAt(page.thread)->badPages.push_back(page);
+            }
+        }
+
+        if (!ok) return path + ":" + std::to_string(lineNumber) + ": linha inválida";
+    }
+
+    if (checkpoint.threads.empty() || checkpoint.bufferSize <= 0) return path + ": checkpoint incompleto";
+
+    return "";
+}
+
+} // namespace memstress
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "memstress/quarantine.hpp"
+#include "memstress/stats.hpp"
+
+namespace memstress
+{
+
+// Estado de uma thread de estresse no checkpoint: contadores, gerador de posicoes e falhas encontradas
+struct ThreadCheckpoint
+{
+    long long operations = 0;
+    long long bytesRead = 0;
+    long long bytesWritten = 0;
+    long long errors = 0;
+    long long maxLatencyNanos = 0;
+    long long quarantinedPages = 0;
+    long long latencySumNanos = 0;
+    std::vector<long long> latencyBuckets;
+
+    // Semente e posicao do gerador de posicoes, vazio para sortear uma nova semente
+    std::string generatorState;
+
+    std::vector<FaultRecord> faults;
+    std::vector<BadPage> badPages;
+};
+
+// Estado de uma execucao do estresse para continuar depois de uma interrupcao. Os enderecos das falhas
+// sao os da execucao original, o buffer da continuacao tem outros enderecos virtuais e fisicos.
+struct StressCheckpoint
+{
+    std::string phase = "estresse";
+    long long bufferSize = 0;
+    double durationSeconds = 0;
+    double elapsedSeconds = 0;
+
+    std::vector<ThreadCheckpoint> threads;
+};
+
+// Grava em um temporario e renomeia, assim uma interrupcao no meio nunca deixa um checkpoint pela metade.
+// Retorna a mensagem de erro, vazia se gravou.
+std::string saveCheckpoint(const std::string& path, const StressCheckpoint& checkpoint);
+
+// Le o checkpoint, retorna a mensagem de erro, vazia se leu
+std::string loadCheckpoint(const std::string& path, StressCheckpoint& checkpoint);
+
+} // namespace memstress
@@ -0,0 +1,224 @@
+#include "memstress/churn.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <random>
+#include "memstress/format.hpp"
+#include "memstress/kernels.hpp"
+#include "memstress/pacing.hpp"
+#include "memstress/system.hpp"
+
+#ifdef __linux__
+    #include <sys/mman.h>
+#endif
+
+namespace memstress
+{
+
+namespace
+{
+
+// Contadores do modo churn, compartilhados entre as threads
+struct ChurnCounters
+{
+    std::atomic<long long> allocations{0};
+    std::atomic<long long> allocationNanos{0};
+    std::atomic<long long> maxAllocationNanos{0};
+};
+
+// Aloca um bloco pelo metodo escolhido, no madvise o bloco eh a propria faixa fixa da thread
+char * churnAllocate(ChurnMethod method, long long size, char * region)
+{
+    if (method == ChurnMethod::Malloc) return static_cast<char *>(std::malloc(size));
+
+    #ifdef __linux__
+        if (method == ChurnMethod::Mmap)
+        {
+            void * mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return mapping == MAP_FAILED ? nullptr : static_cast<char *>(mapping);
+        }
+    #endif
+
+    return region;
+}
+
+// Devolve o bloco, no madvise as paginas sao descartadas mas a faixa continua mapeada
+void churnRelease(ChurnMethod method, char * chunk, long long size)
+{
+    if (method == ChurnMethod::Malloc)
+    {
+        std::free(chunk);
+        return;
+    }
+
+    #ifdef __linux__
+        if (method == ChurnMethod::Mmap)
+        {
+            munmap(chunk, size);
+        }
+        else
+        {
+            madvise(chunk, size, MADV_DONTNEED);
+        }
+    #endif
+}
+
+// Thread do modo churn: aloca, toca cada pagina e libera blocos de tamanhos variados no ritmo pedido
+void churnThread(ChurnMethod method, long long maxChunkSize, uint64_t seed, const RunDeadline& deadline, double allocationsPerSecond, ChurnCounters& counters)
+{
+    const long long pageSize = getPageSize();
+
+    // Com o maximo abaixo de uma pagina o intervalo dos expoentes ficaria invertido
+    maxChunkSize = std::max(maxChunkSize, pageSize);
+
+    char * region = nullptr;
+
+    #ifdef __linux__
+        if (method == ChurnMethod::Madvise)
+        {
+            void * mapping = mmap(nullptr, maxChunkSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (mapping == MAP_FAILED) return;
+
+            region = static_cast<char *>(mapping);
+        }
+    #endif
+
+    std::mt19937_64 sizeGenerator(seed);
+
+    // Tamanhos com distribuicao log-uniforme entre uma pagina e o maximo, como em alocadores reais
+    std::uniform_real_distribution<double> sizeExponentDistribution(std::log2(pageSize), std::log2(maxChunkSize));
+
+    TokenBucket bucket(allocationsPerSecond, std::max(1.0, allocationsPerSecond * 0.002));
+
+    while (!deadline.expired())
+    {
+        bucket.acquire(1);
+
+        long long size = static_cast<long long>(std::exp2(sizeExponentDistribution(sizeGenerator))) / pageSize * pageSize;
+
+        auto allocationStart = std::chrono::steady_clock::now();
+        char * chunk = churnAllocate(method, size, region);
+        auto allocationEnd = std::chrono::steady_clock::now();
+
+        if (chunk == nullptr) continue;
+
+        volatile char * pages = chunk;
+        auto touchStart = std::chrono::steady_clock::now();
+
+        for (long long i = 0; i < size; i += pageSize)
+        {
+            pages[i] = 1;
+        }
+
+        churnRelease(method, chunk, size);
+        auto releaseEnd = std::chrono::steady_clock::now();
+
+        // No madvise a "alocacao" nao faz nada, o custo esta no primeiro toque das paginas descartadas e no
+        // MADV_DONTNEED que as descarta de novo
+        auto cost = method == ChurnMethod::Madvise ? releaseEnd - touchStart : allocationEnd - allocationStart;
+        long long nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(cost).count();
+        long long currentMax = counters.maxAllocationNanos.load(std::memory_order_relaxed);
+
+        while (nanos > currentMax && !counters.maxAllocationNanos.compare_exchange_weak(currentMax, nanos, std::memory_order_relaxed));
+
+        counters.allocationNanos.fetch_add(nanos, std::memory_order_relaxed);
+        counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    #ifdef __linux__
+        if (region != nullptr) munmap(region, maxChunkSize);
+    #endif
+}
+
+} // namespace
+
+ChurnSummary runChurn(int threadCount, const std::vector<int>& placement, const RunDeadline& deadline, ChurnMethod method,
+    long long maxChunkSize, double allocationsPerSecond, uint64_t seed, int reportSeconds, std::ostream * output)
+{
+    ChurnCounters counters;
+    ChurnSummary summary;
+    summary.minRss = summary.maxRss = readResidentSetSize();
+
+    auto startTime = std::chrono::steady_clock::now();
+    long long firstFaults = readMinorPageFaults();
+
+    std::thread reporter([&]() {
+        long long lastAllocations = 0;
+        long long lastNanos = 0;
+        long long lastFaults = firstFaults;
+        auto lastReport = startTime;
+
+        // O RSS eh amostrado a cada 100 ms para captar a oscilacao dentro do intervalo
+        const std::chrono::milliseconds rssSampleTime(100);
+
+        while (!deadline.expired())
+        {
+            auto reportTime = lastReport + std::chrono::seconds(reportSeconds);
+            long long minRss = readResidentSetSize();
+            long long maxRss = minRss;
+
+            while (!deadline.expired() && reportTime > std::chrono::steady_clock::now())
+            {
+                deadline.waitUntil(std::min(reportTime, std::chrono::steady_clock::now() + rssSampleTime));
+
+                long long rss = readResidentSetSize();
+                minRss = std::min(minRss, rss);
+                maxRss = std::max(maxRss, rss);
+            }
+
+            summary.minRss = std::min(summary.minRss, minRss);
+            summary.maxRss = std::max(summary.maxRss, maxRss);
+
+            auto now = std::chrono::steady_clock::now();
+            long long allocations = counters.allocations.load(std::memory_order_relaxed);
+            long long nanos = counters.allocationNanos.load(std::memory_order_relaxed);
+            long long faults = readMinorPageFaults();
+
+            std::chrono::duration<double> interval = now - lastReport;
+            std::chrono::duration<double> elapsed = now - startTime;
+            long long intervalAllocations = allocations - lastAllocations;
+
+            if (output)
+            {
+                std::ios::fmtflags flags = output->flags();
+                std::streamsize precision = output->precision();
+
+                *output << "[" << std::fixed << std::setprecision(1) << elapsed.count() << " s] "
+                    << "alocações/s: " << std::setprecision(0) << intervalAllocations / interval.count()
+                    << ", page faults/s: " << (faults - lastFaults) / interval.count()
+                    << ", latência média de alocação: " << std::setprecision(2)
+                    << (intervalAllocations > 0 ? (nanos - lastNanos) / 1e3 / intervalAllocations : 0) << " us"
+                    << ", RSS: " << formatMiB(minRss) << " - " << formatMiB(maxRss) << std::endl;
+
+                output->flags(flags);
+                output->precision(precision);
+            }
+
+            lastAllocations = allocations;
+            lastNanos = nanos;
+            lastFaults = faults;
+            lastReport = now;
+        }
+    });
+
+    runParallel(threadCount, [&](int index) {
+        churnThread(method, maxChunkSize, streamSeed(seed, index), deadline, allocationsPerSecond / threadCount, counters);
+    }, placement);
+
+    reporter.join();
+
+    std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - startTime;
+
+    summary.allocations = counters.allocations.load();
+    summary.pageFaultsPerSecond = (readMinorPageFaults() - firstFaults) / totalTime.count();
+    summary.meanAllocationUs = summary.allocations > 0 ? counters.allocationNanos.load() / 1e3 / summary.allocations : 0;
+    summary.maxAllocationUs = counters.maxAllocationNanos.load() / 1e3;
+
+    return summary;
+}
+
+} // namespace memstress
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "memstress/parallel.hpp"
+
+namespace memstress
+{
+
+// Metodo de alocacao e liberacao do modo churn
+enum class ChurnMethod
+{
+    Malloc,   // malloc/free
+    Mmap,     // mmap/munmap a cada bloco
+    Madvise   // MADV_DONTNEED em uma faixa fixa por thread
+};
+
+// Resultado do modo churn
+struct ChurnSummary
+{
+    long long allocations = 0;
+    double pageFaultsPerSecond = 0;
+    double meanAllocationUs = 0;
+    double maxAllocationUs = 0;
+    long long minRss = 0;
+    long long maxRss = 0;
+};
+
+// Modo churn: as threads alocam, tocam cada pagina e liberam blocos de tamanhos variados (log-uniforme
+// de uma pagina ate maxChunkSize) no ritmo pedido ate o prazo. Nao usa o buffer principal.
+// Se output nao for nulo, a cada intervalo escreve alocacoes/s, page faults/s, latencia media de
+// alocacao e a oscilacao do RSS no intervalo. No madvise a latencia de alocacao eh a do primeiro toque
+// das paginas somado ao MADV_DONTNEED, ja que o bloco nao eh alocado de novo. Seed 0 sorteia os
+// tamanhos, outro valor os repete. As threads ficam nas CPUs de placement, vazio sem afinidade.
+ChurnSummary runChurn(int threadCount, const std::vector<int>& placement, const RunDeadline& deadline, ChurnMethod method,
+    long long maxChunkSize, double allocationsPerSecond, uint64_t seed, int reportSeconds, std::ostream * output);
+
+} // namespace memstress
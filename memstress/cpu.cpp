@@ -0,0 +1,73 @@
+#include "memstress/cpu.hpp"
+
+#include <fstream>
+
+#ifdef __linux__
+    #include <unistd.h>
+#endif
+
+namespace memstress
+{
+
+namespace
+{
+
+// Le um numero de um arquivo do sysfs, 0 se nao existir
+long long readSysfsNumber(const std::string& path)
+{
+    std::ifstream file(path);
+    long long value = 0;
+
+    file >> value;
+    return value;
+}
+
+CpuFeatures detectCpuFeatures()
+{
+    CpuFeatures features;
+
+    // __builtin_cpu_supports tambem confere se o sistema operacional salva os registradores AVX
+    #if defined(__x86_64__) && defined(__GNUC__)
+        __builtin_cpu_init();
+        features.sse2 = __builtin_cpu_supports("sse2");
+        features.avx2 = __builtin_cpu_supports("avx2");
+        features.avx512 = __builtin_cpu_supports("avx512f");
+        features.nonTemporalStores = features.sse2;
+    #endif
+
+    #ifdef __linux__
+        long long lineSize = sysconf(_SC_LEVEL1_DCACHE_LINESIZE);
+
+        if (lineSize <= 0) lineSize = readSysfsNumber("/sys/devices/system/cpu/cpu0/cache/index0/coherency_line_size");
+        if (lineSize > 0) features.cacheLineSize = lineSize;
+
+        long long cacheSize = sysconf(_SC_LEVEL3_CACHE_SIZE);
+
+        if (cacheSize <= 0) cacheSize = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (cacheSize > 0) features.lastLevelCacheSize = cacheSize;
+    #endif
+
+    return features;
+}
+
+} // namespace
+
+const CpuFeatures& cpuFeatures()
+{
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+std::string describeCpuFeatures()
+{
+    const CpuFeatures& features = cpuFeatures();
+
+    return std::string("SSE2 ") + (features.sse2 ? "sim" : "não")
+        + ", AVX2 " + (features.avx2 ? "sim" : "não")
+        + ", AVX-512 " + (features.avx512 ? "sim" : "não")
+        + ", non-temporal " + (features.nonTemporalStores ? "sim" : "não")
+        + ", linha de cache " + std::to_string(features.cacheLineSize) + " B"
+        + ", última cache " + (features.lastLevelCacheSize > 0 ? std::to_string(features.lastLevelCacheSize / 1024) + " KiB" : "desconhecida");
+}
+
+} // namespace memstress
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <string>
+
+namespace memstress
+{
+
+// Recursos da CPU detectados na inicializacao
+struct CpuFeatures
+{
+    bool sse2 = false;
+    bool avx2 = false;
+    bool avx512 = false;
+
+    // Escritas non-temporal (movnt), que passam direto para a memoria sem ocupar a cache
+    bool nonTemporalStores = false;
+
+    long long cacheLineSize = 64;
+
+    // Tamanho da ultima cache (L3, ou L2 se nao houver L3), 0 se desconhecido
+    long long lastLevelCacheSize = 0;
+};
+
+// Recursos da CPU, detectados uma vez na primeira chamada
+const CpuFeatures& cpuFeatures();
+
+// Resumo dos recursos para mostrar ao usuario
+std::string describeCpuFeatures();
+
+} // namespace memstress
@@ -0,0 +1,171 @@
+#include "memstress/edac.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include "memstress/parallel.hpp"
+#include "memstress/system.hpp"
+
+namespace memstress
+{
+
+namespace
+{
+
+const std::string edacPath = "/sys/devices/system/edac/mc/";
+
+std::string readLine(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string line;
+
+    std::getline(file, line);
+    return line;
+}
+
+long long readCount(const std::string& path)
+{
+    std::ifstream file(path);
+    long long value = 0;
+
+    file >> value;
+    return value;
+}
+
+} // namespace
+
+std::vector<DimmCounters> readEdacDimms()
+{
+    std::vector<DimmCounters> dimms;
+
+    for (const std::string& controller : listEntries(edacPath, "mc"))
+    {
+        // Drivers novos expoem dimmN, os antigos rankN com os mesmos arquivos
+        std::vector<std::string> modules = listEntries(edacPath + controller, "dimm");
+        if (modules.empty()) modules = listEntries(edacPath + controller, "rank");
+
+        for (const std::string& module : modules)
+        {
+            std::string modulePath = edacPath + controller + "/" + module + "/";
+
+            DimmCounters dimm;
+            dimm.name = controller + "/" + module;
+            dimm.label = readLine(modulePath + "dimm_label");
+            dimm.corrected = readCount(modulePath + "dimm_ce_count");
+            dimm.uncorrected = readCount(modulePath + "dimm_ue_count");
+
+            dimms.push_back(dimm);
+        }
+    }
+
+    return dimms;
+}
+
+EdacSnapshot readEdacSnapshot()
+{
+    EdacSnapshot snapshot;
+
+    for (const std::string& controller : listEntries(edacPath, "mc"))
+    {
+        snapshot.available = true;
+        snapshot.corrected += readCount(edacPath + controller + "/ce_count");
+        snapshot.uncorrected += readCount(edacPath + controller + "/ue_count");
+    }
+
+    snapshot.dimms = readEdacDimms();
+    return snapshot;
+}
+
+EdacMonitor::EdacMonitor(std::string phase, int intervalSeconds)
+    : first(readEdacSnapshot()), startTime(std::chrono::steady_clock::now()), interval(intervalSeconds), stopRequested(false)
+{
+    phaseResult.phase = std::move(phase);
+    phaseResult.available = first.available;
+
+    // Sem EDAC nao ha o que acompanhar
+    if (first.available) watcher = std::thread(&EdacMonitor::watch, this);
+}
+
+EdacMonitor::~EdacMonitor()
+{
+    stopWatching();
+}
+
+void EdacMonitor::watch()
+{
+    RunDeadline deadline(std::chrono::time_point<std::chrono::steady_clock>::max(), stopRequested);
+    long long lastCorrected = first.corrected;
+    long long lastUncorrected = first.uncorrected;
+
+    while (!deadline.expired())
+    {
+        deadline.waitUntil(std::chrono::steady_clock::now() + std::chrono::seconds(interval));
+
+        EdacSnapshot snapshot = readEdacSnapshot();
+
+        if (snapshot.corrected == lastCorrected && snapshot.uncorrected == lastUncorrected) continue;
+
+        lastCorrected = snapshot.corrected;
+        lastUncorrected = snapshot.uncorrected;
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        phaseResult.samples.push_back({seconds, snapshot.corrected - first.corrected, snapshot.uncorrected - first.uncorrected});
+    }
+}
+
+void EdacMonitor::stopWatching()
+{
+    stopRequested.store(true);
+    if (watcher.joinable()) watcher.join();
+}
+
+EdacPhase EdacMonitor::finish(double trafficBytes)
+{
+    stopWatching();
+
+    EdacSnapshot last = readEdacSnapshot();
+
+    phaseResult.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    phaseResult.trafficBytes = trafficBytes;
+
+    if (!phaseResult.available) return phaseResult;
+
+    phaseResult.corrected = last.corrected - first.corrected;
+    phaseResult.uncorrected = last.uncorrected - first.uncorrected;
+    phaseResult.increased = edacCountersIncreased(first.dimms, last.dimms);
+
+    return phaseResult;
+}
+
+std::vector<DimmCounters> edacCountersIncreased(const std::vector<DimmCounters>& before, const std::vector<DimmCounters>& after)
+{
+    std::vector<DimmCounters> increased;
+
+    for (const DimmCounters& current : after)
+    {
+        auto previous = std::find_if(before.begin(), before.end(), [&](const DimmCounters& dimm) { return dimm.name == current.name; });
+
+        DimmCounters difference = current;
+
+        if (previous != before.end())
+        {
+            difference.corrected -= previous->corrected;
+            difference.uncorrected -= previous->uncorrected;
+        }
+
+        if (difference.corrected > 0 || difference.uncorrected > 0) increased.push_back(difference);
+    }
+
+    return increased;
+}
+
+std::string suspectDimmLabel(const std::vector<DimmCounters>& dimms, const std::vector<DimmCounters>& increased)
+{
+    const std::vector<DimmCounters> * candidates = increased.size() == 1 ? &increased : &dimms;
+
+    if (candidates->size() != 1) return "";
+
+    const DimmCounters& dimm = candidates->front();
+    return dimm.label.empty() ? dimm.name : dimm.label + " (" + dimm.name + ")";
+}
+
+} // namespace memstress
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace memstress
+{
+
+// Contadores de erro de um DIMM no EDAC (/sys/devices/system/edac/mc/mcN/dimmM)
+struct DimmCounters
+{
+    std::string name;     // "mc0/dimm3"
+    std::string label;    // rotulo do slot configurado na BIOS/driver, ex. "CPU_SrcID#0_MC#0_Chan#1_DIMM#0"
+    long long corrected = 0;
+    long long uncorrected = 0;
+};
+
+// DIMMs que o EDAC conhece, vazio se o driver nao estiver carregado
+std::vector<DimmCounters> readEdacDimms();
+
+// Todos os contadores do EDAC: totais dos controladores (mcN/ce_count e ue_count) e os de cada DIMM
+struct EdacSnapshot
+{
+    bool available = false;
+    long long corrected = 0;
+    long long uncorrected = 0;
+    std::vector<DimmCounters> dimms;
+};
+
+EdacSnapshot readEdacSnapshot();
+
+// Erros acumulados desde o inicio da fase em uma leitura periodica
+struct EdacSample
+{
+    double seconds;
+    long long corrected;
+    long long uncorrected;
+};
+
+// Erros do EDAC em uma fase e o trafego que ela gerou
+struct EdacPhase
+{
+    std::string phase;
+    bool available = false;
+    double seconds = 0;
+
+    // Bytes lidos e escritos pelos kernels da fase, 0 se a fase nao mede o trafego
+    double trafficBytes = 0;
+
+    long long corrected = 0;
+    long long uncorrected = 0;
+    std::vector<DimmCounters> increased;
+
+    // Leituras periodicas em que os contadores mudaram
+    std::vector<EdacSample> samples;
+
+    double gbps() const { return seconds > 0 ? trafficBytes / 1e9 / seconds : 0; }
+
+    // Erros corrigidos por GB de trafego, ou seja a taxa de CE/s dividida pela banda em GB/s
+    double correctedPerGB() const { return trafficBytes > 0 ? corrected / (trafficBytes / 1e9) : 0; }
+};
+
+// Acompanha o EDAC durante uma fase: le no inicio, a cada intervalo em uma thread propria e no fim
+class EdacMonitor
+{
+public:
+    EdacMonitor(std::string phase, int intervalSeconds);
+    ~EdacMonitor();
+
+    EdacMonitor(const EdacMonitor&) = delete;
+    EdacMonitor& operator=(const EdacMonitor&) = delete;
+
+    // Para as leituras periodicas e fecha a fase com o trafego gerado
+    EdacPhase finish(double trafficBytes);
+
+private:
+    void watch();
+    void stopWatching();
+
+    EdacPhase phaseResult;
+    EdacSnapshot first;
+    std::chrono::time_point<std::chrono::steady_clock> startTime;
+    int interval;
+
+    std::atomic<bool> stopRequested;
+    std::thread watcher;
+};
+
+// DIMMs cujos contadores subiram entre as duas leituras, com a diferenca nos contadores
+std::vector<DimmCounters> edacCountersIncreased(const std::vector<DimmCounters>& before, const std::vector<DimmCounters>& after);
+
+// Rotulo do DIMM responsavel pelas falhas: o unico cujo contador subiu, ou o unico DIMM da maquina.
+// Vazio se o EDAC nao permitir apontar um so. O EDAC nao expoe a decodificacao endereco -> DIMM no sysfs,
+// entao o endereco fisico vai junto no relatorio para a decodificacao pelo fabricante.
+std::string suspectDimmLabel(const std::vector<DimmCounters>& dimms, const std::vector<DimmCounters>& increased);
+
+} // namespace memstress
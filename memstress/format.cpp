@@ -0,0 +1,31 @@
+#include "memstress/format.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+namespace memstress
+{
+
+std::string formatMiB(unsigned long long bytes)
+{
+    return std::to_string(bytes / (1024 * 1024)) + " MiB";
+}
+
+std::string formatSize(long long bytes)
+{
+    const char * units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    int unit = 0;
+    double size = bytes;
+
+    while (size >= 1024 && unit < 4)
+    {
+        size /= 1024;
+        unit++;
+    }
+
+    std::ostringstream formatted;
+    formatted << std::setprecision(4) << size << " " << units[unit];
+    return formatted.str();
+}
+
+} // namespace memstress
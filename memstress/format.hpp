@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+namespace memstress
+{
+
+// Formata uma quantidade de bytes em MiB para os relatorios
+std::string formatMiB(unsigned long long bytes);
+
+// Formata um tamanho em B, KiB, MiB ou GiB
+std::string formatSize(long long bytes);
+
+} // namespace memstress
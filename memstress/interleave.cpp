@@ -0,0 +1,537 @@
+#include "memstress/interleave.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <unordered_map>
+#include "memstress/cpu.hpp"
+#include "memstress/format.hpp"
+#include "memstress/parallel.hpp"
+#include "memstress/system.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define MEMSTRESS_HAS_CLFLUSH
+    #include <immintrin.h>
+#endif
+
+#ifdef __linux__
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace memstress
+{
+
+namespace
+{
+
+// Pares de enderecos medidos por bit e alternancias em cada par
+const int latencyBases = 48;
+const int latencyRounds = 200;
+
+// Latencia maxima sobre a minima a partir da qual ha conflito de linha entre os bits
+const double rowConflictFactor = 1.25;
+
+// Banda relativa abaixo da qual o bit escolhe o canal. O ideal eh 0.5 com dois canais, mas o prefetcher
+// de linha adjacente e a densidade menor de linhas por pagina ja derrubam os bits baixos para perto de 0.7.
+const double channelBandwidthRatio = 0.6;
+
+// Canal com banda abaixo desta fracao da mediana eh marcado como lento
+const double slowChannelFactor = 0.85;
+
+// Limita os canais isolados a 2^4 combinacoes
+const int maxChannelBits = 4;
+
+// Bits acima deste nao sao sondados mesmo com enderecos fisicos
+const int highestProbedBit = 38;
+
+// Paginas enormes de 2 MiB (THP): sem pagemap os bits abaixo de 21 do endereco virtual sao os fisicos
+const int hugePageShift = 21;
+
+// Embaralha as linhas de uma pagina, impar para ser uma permutacao das linhas
+const long long lineScramble = 23;
+
+int log2Of(long long value)
+{
+    int bits = 0;
+
+    while ((1LL << (bits + 1)) <= value) bits++;
+
+    return bits;
+}
+
+// Traducao do deslocamento no buffer para o endereco usado na sondagem: fisico pelo pagemap quando o
+// processo tem privilegio para ler os frames, senao o virtual
+class AddressMap
+{
+public:
+    AddressMap(const volatile char * data, long long size)
+        : base(reinterpret_cast<uintptr_t>(data)), regionSize(size), pageSize(getPageSize()), pageShift(log2Of(pageSize))
+    {
+        readFrames();
+    }
+
+    bool physical() const { return !frames.empty(); }
+
+    // Maior bit com pares de enderecos confiaveis dentro da regiao
+    int maxBit(double hugePageCoverage) const
+    {
+        if (!physical()) return (hugePageCoverage >= 0.5 ? hugePageShift : pageShift) - 1;
+
+        unsigned long long highest = *std::max_element(frames.begin(), frames.end()) * pageSize;
+        return std::min(highestProbedBit, log2Of(static_cast<long long>(highest)));
+    }
+
+    unsigned long long address(long long offset) const
+    {
+        if (frames.empty()) return base + offset;
+
+        return frames[offset / pageSize] * pageSize + offset % pageSize;
+    }
+
+    // Deslocamento cujo endereco difere apenas no bit, -1 se ele nao estiver na regiao
+    long long partner(long long offset, int bit) const
+    {
+        unsigned long long target = address(offset) ^ (1ULL << bit);
+
+        if (frames.empty() || bit < pageShift)
+        {
+            long long other = offset + static_cast<long long>(target - address(offset));
+            return other >= 0 && other < regionSize ? other : -1;
+        }
+
+        auto page = pageOfFrame.find(target / pageSize);
+        return page == pageOfFrame.end() ? -1 : page->second * pageSize + offset % pageSize;
+    }
+
+private:
+    // Le os frames de cada pagina, sem privilegio o kernel devolve zero e a sondagem fica nos virtuais
+    void readFrames()
+    {
+        #ifdef __linux__
+            int file = open("/proc/self/pagemap", O_RDONLY);
+
+            if (file < 0) return;
+
+            const unsigned long long frameMask = (1ULL << 55) - 1;
+            long long pageCount = regionSize / pageSize;
+            std::vector<uint64_t> entries(pageCount);
+
+            ssize_t expected = pageCount * sizeof(uint64_t);
+            ssize_t readBytes = pread(file, entries.data(), expected, (base / pageSize) * sizeof(uint64_t));
+
+            close(file);
+
+            if (readBytes != expected) return;
+
+            for (long long page = 0; page < pageCount; page++)
+            {
+                unsigned long long frame = entries[page] & frameMask;
+
+                if (frame == 0)
+                {
+                    frames.clear();
+                    pageOfFrame.clear();
+                    return;
+                }
+
+                frames.push_back(frame);
+                pageOfFrame[frame] = page;
+            }
+        #endif
+    }
+
+    uintptr_t base;
+    long long regionSize;
+    long long pageSize;
+    int pageShift;
+    std::vector<unsigned long long> frames;
+    std::unordered_map<unsigned long long, long long> pageOfFrame;
+};
+
+// Fracao do mapeamento do buffer coberta por paginas enormes, pelo AnonHugePages do /proc/self/smaps
+double readHugePageCoverage(const volatile char * data)
+{
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    uintptr_t address = reinterpret_cast<uintptr_t>(data);
+    long long mappingSize = 0;
+
+    while (std::getline(smaps, line))
+    {
+        unsigned long long start = 0;
+        unsigned long long end = 0;
+        char separator = 0;
+        std::istringstream header(line);
+
+        if (mappingSize == 0)
+        {
+            if (header >> std::hex >> start >> separator >> end && separator == '-' && start <= address && address < end)
+            {
+                mappingSize = end - start;
+            }
+
+            continue;
+        }
+
+        if (line.compare(0, 14, "AnonHugePages:") == 0)
+        {
+            long long hugeKiB = std::stoll(line.substr(14));
+            return static_cast<double>(hugeKiB * 1024) / mappingSize;
+        }
+    }
+
+    return 0;
+}
+
+#ifdef MEMSTRESS_HAS_CLFLUSH
+
+// Latencia media de ler dois enderecos tirando os dois da cache a cada vez. Se estiverem no mesmo banco
+// em linhas diferentes, o banco fecha e abre a linha a cada acesso e a latencia sobe (conflito de linha).
+double pairLatency(volatile char * first, volatile char * second)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < latencyRounds; i++)
+    {
+        static_cast<void>(*first);
+        static_cast<void>(*second);
+
+        _mm_clflush(const_cast<char *>(first));
+        _mm_clflush(const_cast<char *>(second));
+        _mm_mfence();
+    }
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / latencyRounds;
+}
+
+#endif
+
+// Mediana da latencia entre enderecos que diferem exatamente nos bits pedidos, -1 sem pares na regiao
+double bitsLatency(const AddressMap& map, volatile char * data, long long region, const std::vector<int>& bits, std::mt19937_64& generator)
+{
+    #ifdef MEMSTRESS_HAS_CLFLUSH
+        const long long lineSize = cpuFeatures().cacheLineSize;
+        std::uniform_int_distribution<long long> lineDistribution(0, region / lineSize - 1);
+        std::vector<double> samples;
+
+        for (int attempt = 0; attempt < latencyBases * 8 && static_cast<int>(samples.size()) < latencyBases; attempt++)
+        {
+            long long offset = lineDistribution(generator) * lineSize;
+            long long other = offset;
+
+            for (int bit : bits)
+            {
+                if (other >= 0) other = map.partner(other, bit);
+            }
+
+            if (other < 0) continue;
+
+            samples.push_back(pairLatency(data + offset, data + other));
+        }
+
+        if (samples.empty()) return -1;
+
+        std::nth_element(samples.begin(), samples.begin() + samples.size() / 2, samples.end());
+        return samples[samples.size() / 2];
+    #else
+        (void)map;
+        (void)data;
+        (void)region;
+        (void)bits;
+        (void)generator;
+        return -1;
+    #endif
+}
+
+// Passo entre paginas primo com a quantidade, para visitar todas fora de ordem
+long long coprimeStride(long long count)
+{
+    long long stride = std::max(1LL, count * 5 / 8);
+
+    while (std::gcd(stride, count) != 1) stride++;
+
+    return stride;
+}
+
+// Banda lendo so as linhas da regiao cujo endereco tem value nos bits da mascara. Paginas e linhas sao
+// visitadas fora de ordem para os prefetchers nao trazerem as linhas puladas.
+double selectiveBandwidth(const AddressMap& map, volatile char * data, long long region,
+    unsigned long long mask, unsigned long long value, int threadCount, const std::vector<int>& placement)
+{
+    const long long pageSize = getPageSize();
+    const long long lineSize = cpuFeatures().cacheLineSize;
+    const long long linesPerPage = pageSize / lineSize;
+    const unsigned long long offsetMask = pageSize - 1;
+
+    // A parte da mascara dentro da pagina escolhe as mesmas linhas em toda pagina, e a parte de cima
+    // escolhe paginas inteiras. Assim o laco de leitura nao tem desvio imprevisivel por linha.
+    std::vector<long long> pageLines;
+
+    for (long long line = 0; line < linesPerPage; line++)
+    {
+        long long offset = (line * lineScramble) % linesPerPage * lineSize;
+
+        if ((offset & mask & offsetMask) == (value & offsetMask)) pageLines.push_back(offset);
+    }
+
+    std::vector<long long> lines(threadCount, 0);
+    std::vector<uint64_t> sums(threadCount, 0);
+
+    auto start = std::chrono::steady_clock::now();
+
+    runParallel(threadCount, [&](int index) {
+        Range pages = partitionRange(region / pageSize, threadCount, index);
+        long long pageCount = pages.finalIndex - pages.startIndex;
+
+        if (pageCount <= 0) return;
+
+        long long stride = coprimeStride(pageCount);
+        long long count = 0;
+        uint64_t sum = 0;
+
+        for (long long k = 0; k < pageCount; k++)
+        {
+            long long page = pages.startIndex + (k * stride) % pageCount;
+
+            if ((map.address(page * pageSize) & mask & ~offsetMask) != (value & ~offsetMask)) continue;
+
+            volatile char * pageData = data + page * pageSize;
+
+            for (long long offset : pageLines)
+            {
+                sum += *reinterpret_cast<volatile uint64_t *>(pageData + offset);
+            }
+
+            count += pageLines.size();
+        }
+
+        lines[index] = count;
+        sums[index] = sum;
+    }, placement);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    long long totalLines = std::accumulate(lines.begin(), lines.end(), 0LL);
+
+    return totalLines * lineSize / 1e9 / elapsed.count();
+}
+
+const char * roleName(AddressBitRole role)
+{
+    switch (role)
+    {
+        case AddressBitRole::Row: return "linha";
+        case AddressBitRole::Bank: return "banco";
+        case AddressBitRole::Channel: return "canal";
+        default: return "coluna";
+    }
+}
+
+void reportBits(const InterleaveSummary& summary, std::ostream& output)
+{
+    std::ios::fmtflags flags = output.flags();
+    std::streamsize precision = output.precision();
+
+    // Cabecalho escrito direto, setw conta os acentos em bytes e desalinharia as colunas
+    output << "Bit   Latência (ns)   Banda relativa   Função" << std::endl;
+
+    for (const AddressBitProbe& probe : summary.bits)
+    {
+        output << std::left << std::fixed << std::setprecision(2)
+            << std::setw(6) << probe.bit
+            << std::setw(16) << probe.latencyNs;
+
+        if (probe.bandwidthRatio > 0)
+        {
+            output << std::setw(17) << probe.bandwidthRatio;
+        } else {
+            output << std::setw(17) << "-";
+        }
+
+        output << roleName(probe.role) << std::endl;
+    }
+
+    output.flags(flags);
+    output.precision(precision);
+}
+
+void reportChannels(const InterleaveSummary& summary, std::ostream& output)
+{
+    output << "\nBits de canal:";
+    for (int bit : summary.channelBits) output << " " << bit;
+    output << std::endl;
+
+    output << "Canal   Banda (GB/s)" << std::endl;
+
+    for (const ChannelBandwidth& channel : summary.channels)
+    {
+        std::string selector;
+
+        for (size_t i = summary.channelBits.size(); i-- > 0; ) selector += (channel.selector >> i) & 1 ? '1' : '0';
+
+        output << std::left << std::setw(8) << selector << std::setw(13) << channel.gbps
+            << (channel.slow ? "lento" : "") << std::right << std::endl;
+    }
+}
+
+} // namespace
+
+InterleaveSummary runInterleave(Buffer& buffer, int threadCount, const std::vector<int>& placement, std::ostream * output)
+{
+    InterleaveSummary summary;
+
+    #ifndef MEMSTRESS_HAS_CLFLUSH
+        summary.unavailableReason = "a sondagem precisa de clflush (x86)";
+        if (output) *output << "Modo interleave indisponível: " << summary.unavailableReason << std::endl;
+        return summary;
+    #endif
+
+    // Regiao grande o bastante para sair da ultima cache na medicao de banda, sem ler o pagemap do buffer inteiro
+    const long long pageSize = getPageSize();
+    long long cacheSize = cpuFeatures().lastLevelCacheSize;
+    long long region = std::min(buffer.size(), std::max(4 * cacheSize, 256LL * 1024 * 1024)) / pageSize * pageSize;
+
+    if (region < 2 * (1LL << hugePageShift))
+    {
+        summary.unavailableReason = "buffer menor que 4 MiB";
+        if (output) *output << "Modo interleave indisponível: " << summary.unavailableReason << std::endl;
+        return summary;
+    }
+
+    summary.available = true;
+
+    AddressMap map(buffer.data(), region);
+    summary.physicalAddresses = map.physical();
+    summary.hugePageCoverage = readHugePageCoverage(buffer.data());
+
+    if (output)
+    {
+        *output << "Região sondada: " << formatSize(region) << ", endereços "
+            << (summary.physicalAddresses ? "físicos (pagemap)" : "virtuais") << ", "
+            << static_cast<int>(summary.hugePageCoverage * 100) << "% em páginas enormes" << std::endl;
+
+        if (!summary.physicalAddresses)
+        {
+            *output << "Sem acesso aos frames do pagemap (rode como root para sondar os bits altos)" << std::endl;
+        }
+
+        *output << std::endl;
+    }
+
+    // 1) Latencia alternando enderecos que diferem em um so bit: alta nos bits que so mudam a linha
+    std::mt19937_64 generator(std::random_device{}());
+    int lineShift = log2Of(cpuFeatures().cacheLineSize);
+
+    for (int bit = lineShift; bit <= map.maxBit(summary.hugePageCoverage); bit++)
+    {
+        double latency = bitsLatency(map, buffer.data(), region, {bit}, generator);
+
+        if (latency > 0) summary.bits.push_back({bit, latency, 0, AddressBitRole::Column});
+    }
+
+    if (summary.bits.empty()) return summary;
+
+    auto latencyOrder = [](const AddressBitProbe& first, const AddressBitProbe& second) { return first.latencyNs < second.latencyNs; };
+    double minLatency = std::min_element(summary.bits.begin(), summary.bits.end(), latencyOrder)->latencyNs;
+    double maxLatency = std::max_element(summary.bits.begin(), summary.bits.end(), latencyOrder)->latencyNs;
+    double conflictThreshold = (minLatency + maxLatency) / 2;
+    int rowBit = -1;
+
+    if (maxLatency > minLatency * rowConflictFactor)
+    {
+        for (AddressBitProbe& probe : summary.bits)
+        {
+            if (probe.latencyNs <= conflictThreshold) continue;
+
+            probe.role = AddressBitRole::Row;
+            if (rowBit < 0) rowBit = probe.bit;
+        }
+    }
+
+    // 2) Mudando tambem um bit de linha: se o conflito some o bit troca o banco, se continua eh de coluna
+    if (rowBit >= 0)
+    {
+        for (AddressBitProbe& probe : summary.bits)
+        {
+            if (probe.role == AddressBitRole::Row) continue;
+
+            double latency = bitsLatency(map, buffer.data(), region, {probe.bit, rowBit}, generator);
+
+            if (latency > 0 && latency <= conflictThreshold) probe.role = AddressBitRole::Bank;
+        }
+    }
+
+    // 3) Banda lendo so as linhas com o bit em 0: cai pela metade se o bit escolhe o canal
+    selectiveBandwidth(map, buffer.data(), region, 0, 0, threadCount, placement);
+    double totalBandwidth = selectiveBandwidth(map, buffer.data(), region, 0, 0, threadCount, placement);
+    std::vector<AddressBitProbe *> channelCandidates;
+
+    for (AddressBitProbe& probe : summary.bits)
+    {
+        if (probe.role == AddressBitRole::Row) continue;
+
+        probe.bandwidthRatio = selectiveBandwidth(map, buffer.data(), region, 1ULL << probe.bit, 0, threadCount, placement) / totalBandwidth;
+
+        if (probe.bandwidthRatio < channelBandwidthRatio)
+        {
+            probe.role = AddressBitRole::Channel;
+            channelCandidates.push_back(&probe);
+        }
+    }
+
+    if (output) reportBits(summary, *output);
+
+    // 4) Banda de cada canal isolado, fixando todos os bits de canal
+    std::sort(channelCandidates.begin(), channelCandidates.end(), [](const AddressBitProbe * first, const AddressBitProbe * second) {
+        return first->bandwidthRatio < second->bandwidthRatio;
+    });
+
+    unsigned long long channelMask = 0;
+
+    for (size_t i = 0; i < channelCandidates.size() && static_cast<int>(i) < maxChannelBits; i++)
+    {
+        summary.channelBits.push_back(channelCandidates[i]->bit);
+    }
+
+    std::sort(summary.channelBits.begin(), summary.channelBits.end());
+
+    if (summary.channelBits.empty())
+    {
+        if (output) *output << "\nNenhum bit de canal encontrado (canal único ou escolhido por hash de vários bits)" << std::endl;
+        return summary;
+    }
+
+    for (int bit : summary.channelBits) channelMask |= 1ULL << bit;
+
+    for (unsigned long long selector = 0; selector < (1ULL << summary.channelBits.size()); selector++)
+    {
+        unsigned long long value = 0;
+
+        for (size_t i = 0; i < summary.channelBits.size(); i++)
+        {
+            if ((selector >> i) & 1) value |= 1ULL << summary.channelBits[i];
+        }
+
+        summary.channels.push_back({selector, selectiveBandwidth(map, buffer.data(), region, channelMask, value, threadCount, placement), false});
+    }
+
+    std::vector<double> bandwidths;
+    for (const ChannelBandwidth& channel : summary.channels) bandwidths.push_back(channel.gbps);
+
+    std::nth_element(bandwidths.begin(), bandwidths.begin() + bandwidths.size() / 2, bandwidths.end());
+    double median = bandwidths[bandwidths.size() / 2];
+
+    for (ChannelBandwidth& channel : summary.channels) channel.slow = channel.gbps < median * slowChannelFactor;
+
+    if (output) reportChannels(summary, *output);
+
+    return summary;
+}
+
+} // namespace memstress
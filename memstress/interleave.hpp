@@ -0,0 +1,57 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "memstress/buffer.hpp"
+
+namespace memstress
+{
+
+// Papel de um bit do endereco fisico no controlador de memoria
+enum class AddressBitRole
+{
+    Column,   // mesma linha do banco: acessos alternados acertam o row buffer
+    Row,      // mesmo banco e outra linha: acessos alternados geram conflito de linha
+    Bank,     // muda o banco (sozinho ou em XOR com outros bits)
+    Channel   // muda o canal: restringir o acesso a um valor do bit corta a banda
+};
+
+struct AddressBitProbe
+{
+    int bit;
+    double latencyNs;         // acesso alternado entre enderecos que diferem so neste bit
+    double bandwidthRatio;    // banda com o bit fixo em 0 sobre a banda total, 0 se nao medida
+    AddressBitRole role;
+};
+
+// Banda lendo apenas as linhas de um canal, identificado pelo valor dos bits de canal
+struct ChannelBandwidth
+{
+    unsigned long long selector;
+    double gbps;
+    bool slow;
+};
+
+struct InterleaveSummary
+{
+    // false se a plataforma nao tiver clflush ou o buffer for pequeno demais para medir
+    bool available = false;
+    std::string unavailableReason;
+
+    // Enderecos fisicos via /proc/self/pagemap (exige privilegio), senao virtuais dentro de paginas enormes
+    bool physicalAddresses = false;
+    double hugePageCoverage = 0;
+
+    std::vector<AddressBitProbe> bits;
+    std::vector<int> channelBits;
+    std::vector<ChannelBandwidth> channels;
+};
+
+// Modo interleave: descobre pelo tempo de acesso quais bits do endereco escolhem linha, banco e canal,
+// e mede a banda de cada canal isolado, para achar um canal lento ou falhando que a media do buffer
+// inteiro esconde. As medicoes de banda usam threadCount threads presas nas CPUs de placement (vazio sem
+// afinidade). Se output nao for nulo, as tabelas sao escritas conforme as medicoes terminam.
+InterleaveSummary runInterleave(Buffer& buffer, int threadCount, const std::vector<int>& placement, std::ostream * output);
+
+} // namespace memstress
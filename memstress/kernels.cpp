@@ -0,0 +1,500 @@
+#include "memstress/kernels.hpp"
+
+#include <cstring>
+#include <utility>
+#include "memstress/cpu.hpp"
+
+// Versoes SSE2, AVX2 e AVX-512 compiladas com atributo target, sem exigir flags de compilacao,
+// e escolhidas em tempo de execucao conforme a CPU
+#if defined(MEMSTRESS_MULTIVERSION) && defined(__x86_64__) && defined(__GNUC__)
+    #define MEMSTRESS_X86_KERNELS
+    #include <immintrin.h>
+#endif
+
+namespace memstress
+{
+
+namespace
+{
+
+// Palavra de 64 bits com o padrao alternado dos 8 bytes a partir da posicao
+uint64_t patternWord(long long index)
+{
+    char bytes[sizeof(uint64_t)];
+    uint64_t word;
+
+    for (long long i = 0; i < static_cast<long long>(sizeof(uint64_t)); i++) bytes[i] = patternValue<char>(index + i);
+
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+// Faixa dividida em cabeca e cauda tratadas byte a byte e um corpo alinhado para o kernel.
+// O corpo comeca em endereco multiplo do alinhamento, e como o alinhamento eh par o padrao dele eh fixo.
+struct AlignedSpan
+{
+    long long bodyStart;
+    long long bodyEnd;
+};
+
+AlignedSpan alignSpan(const char * buffer, long long startIndex, long long finalIndex, long long alignment)
+{
+    long long misalignment = reinterpret_cast<uintptr_t>(buffer + startIndex) % alignment;
+    long long bodyStart = startIndex + (misalignment == 0 ? 0 : alignment - misalignment);
+
+    if (bodyStart > finalIndex) bodyStart = finalIndex;
+
+    return {bodyStart, bodyStart + (finalIndex - bodyStart) / alignment * alignment};
+}
+
+void fillBytes(char * buffer, long long startIndex, long long finalIndex)
+{
+    for (long long i = startIndex; i < finalIndex; i++) buffer[i] = patternValue<char>(i);
+}
+
+long long countBytes(const char * buffer, long long startIndex, long long finalIndex)
+{
+    long long mismatches = 0;
+
+    for (long long i = startIndex; i < finalIndex; i++) mismatches += buffer[i] != patternValue<char>(i);
+
+    return mismatches;
+}
+
+void invertBytes(char * buffer, long long startIndex, long long finalIndex)
+{
+    for (long long i = startIndex; i < finalIndex; i++) buffer[i] = ~buffer[i];
+}
+
+void swapBytes(char * first, char * second, long long startIndex, long long finalIndex)
+{
+    for (long long i = startIndex; i < finalIndex; i++) std::swap(first[i], second[i]);
+}
+
+// Versoes genericas em palavras de 64 bits, vetorizadas pelo compilador para o conjunto base
+
+void fillGeneric(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, sizeof(uint64_t));
+    const uint64_t word = patternWord(span.bodyStart);
+    uint64_t * words = reinterpret_cast<uint64_t *>(buffer + span.bodyStart);
+    long long wordCount = (span.bodyEnd - span.bodyStart) / sizeof(uint64_t);
+
+    fillBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = 0; i < wordCount; i++)
+    {
+        words[i] = word;
+    }
+
+    fillBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+long long verifyGeneric(const char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, sizeof(uint64_t));
+    const uint64_t word = patternWord(span.bodyStart);
+    const uint64_t * words = reinterpret_cast<const uint64_t *>(buffer + span.bodyStart);
+    long long wordCount = (span.bodyEnd - span.bodyStart) / sizeof(uint64_t);
+
+    // Acumula as diferencas no laco vetorizavel e so procura os bytes errados se houver alguma
+    uint64_t differences = 0;
+
+    for (long long i = 0; i < wordCount; i++)
+    {
+        differences |= words[i] ^ word;
+    }
+
+    long long mismatches = countBytes(buffer, startIndex, span.bodyStart) + countBytes(buffer, span.bodyEnd, finalIndex);
+
+    return mismatches + (differences != 0 ? countBytes(buffer, span.bodyStart, span.bodyEnd) : 0);
+}
+
+void invertGeneric(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, sizeof(uint64_t));
+    uint64_t * words = reinterpret_cast<uint64_t *>(buffer + span.bodyStart);
+    long long wordCount = (span.bodyEnd - span.bodyStart) / sizeof(uint64_t);
+
+    invertBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = 0; i < wordCount; i++)
+    {
+        words[i] = ~words[i];
+    }
+
+    invertBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+void swapGeneric(char * first, char * second, long long length)
+{
+    long long wordEnd = length / sizeof(uint64_t) * sizeof(uint64_t);
+
+    for (long long i = 0; i < wordEnd; i += sizeof(uint64_t))
+    {
+        uint64_t firstWord, secondWord;
+
+        std::memcpy(&firstWord, first + i, sizeof(uint64_t));
+        std::memcpy(&secondWord, second + i, sizeof(uint64_t));
+        std::memcpy(first + i, &secondWord, sizeof(uint64_t));
+        std::memcpy(second + i, &firstWord, sizeof(uint64_t));
+    }
+
+    swapBytes(first, second, wordEnd, length);
+}
+
+#ifdef MEMSTRESS_X86_KERNELS
+
+// SSE2: registradores de 16 bytes
+
+__attribute__((target("sse2")))
+void fillSse2(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 16);
+    const __m128i pattern = _mm_set1_epi64x(patternWord(span.bodyStart));
+
+    fillBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 16)
+    {
+        _mm_store_si128(reinterpret_cast<__m128i *>(buffer + i), pattern);
+    }
+
+    fillBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("sse2")))
+void fillSse2Streaming(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 16);
+    const __m128i pattern = _mm_set1_epi64x(patternWord(span.bodyStart));
+
+    fillBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 16)
+    {
+        _mm_stream_si128(reinterpret_cast<__m128i *>(buffer + i), pattern);
+    }
+
+    // Garante que as escritas non-temporal fiquem visiveis antes de outras threads lerem o buffer
+    _mm_sfence();
+
+    fillBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("sse2")))
+long long verifySse2(const char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 16);
+    const __m128i pattern = _mm_set1_epi64x(patternWord(span.bodyStart));
+    __m128i differences = _mm_setzero_si128();
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 16)
+    {
+        __m128i data = _mm_load_si128(reinterpret_cast<const __m128i *>(buffer + i));
+        differences = _mm_or_si128(differences, _mm_xor_si128(data, pattern));
+    }
+
+    bool hasDifferences = _mm_movemask_epi8(_mm_cmpeq_epi8(differences, _mm_setzero_si128())) != 0xFFFF;
+    long long mismatches = countBytes(buffer, startIndex, span.bodyStart) + countBytes(buffer, span.bodyEnd, finalIndex);
+
+    return mismatches + (hasDifferences ? countBytes(buffer, span.bodyStart, span.bodyEnd) : 0);
+}
+
+__attribute__((target("sse2")))
+void invertSse2(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 16);
+    const __m128i ones = _mm_set1_epi32(-1);
+
+    invertBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 16)
+    {
+        __m128i * data = reinterpret_cast<__m128i *>(buffer + i);
+        _mm_store_si128(data, _mm_xor_si128(_mm_load_si128(data), ones));
+    }
+
+    invertBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("sse2")))
+void swapSse2(char * first, char * second, long long length)
+{
+    long long vectorEnd = length / 16 * 16;
+
+    for (long long i = 0; i < vectorEnd; i += 16)
+    {
+        __m128i firstData = _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + i));
+        __m128i secondData = _mm_loadu_si128(reinterpret_cast<const __m128i *>(second + i));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(first + i), secondData);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(second + i), firstData);
+    }
+
+    swapBytes(first, second, vectorEnd, length);
+}
+
+// AVX2: registradores de 32 bytes
+
+__attribute__((target("avx2")))
+void fillAvx2(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 32);
+    const __m256i pattern = _mm256_set1_epi64x(patternWord(span.bodyStart));
+
+    fillBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 32)
+    {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(buffer + i), pattern);
+    }
+
+    fillBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("avx2")))
+void fillAvx2Streaming(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 32);
+    const __m256i pattern = _mm256_set1_epi64x(patternWord(span.bodyStart));
+
+    fillBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 32)
+    {
+        _mm256_stream_si256(reinterpret_cast<__m256i *>(buffer + i), pattern);
+    }
+
+    _mm_sfence();
+
+    fillBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("avx2")))
+long long verifyAvx2(const char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 32);
+    const __m256i pattern = _mm256_set1_epi64x(patternWord(span.bodyStart));
+    __m256i differences = _mm256_setzero_si256();
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 32)
+    {
+        __m256i data = _mm256_load_si256(reinterpret_cast<const __m256i *>(buffer + i));
+        differences = _mm256_or_si256(differences, _mm256_xor_si256(data, pattern));
+    }
+
+    bool hasDifferences = !_mm256_testz_si256(differences, differences);
+    long long mismatches = countBytes(buffer, startIndex, span.bodyStart) + countBytes(buffer, span.bodyEnd, finalIndex);
+
+    return mismatches + (hasDifferences ? countBytes(buffer, span.bodyStart, span.bodyEnd) : 0);
+}
+
+__attribute__((target("avx2")))
+void invertAvx2(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 32);
+    const __m256i ones = _mm256_set1_epi32(-1);
+
+    invertBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 32)
+    {
+        __m256i * data = reinterpret_cast<__m256i *>(buffer + i);
+        _mm256_store_si256(data, _mm256_xor_si256(_mm256_load_si256(data), ones));
+    }
+
+    invertBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("avx2")))
+void swapAvx2(char * first, char * second, long long length)
+{
+    long long vectorEnd = length / 32 * 32;
+
+    for (long long i = 0; i < vectorEnd; i += 32)
+    {
+        __m256i firstData = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + i));
+        __m256i secondData = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(second + i));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(first + i), secondData);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(second + i), firstData);
+    }
+
+    swapBytes(first, second, vectorEnd, length);
+}
+
+// AVX-512: registradores de 64 bytes, uma linha de cache inteira por instrucao
+
+__attribute__((target("avx512f")))
+void fillAvx512(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 64);
+    const __m512i pattern = _mm512_set1_epi64(patternWord(span.bodyStart));
+
+    fillBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 64)
+    {
+        _mm512_store_si512(reinterpret_cast<__m512i *>(buffer + i), pattern);
+    }
+
+    fillBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("avx512f")))
+void fillAvx512Streaming(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 64);
+    const __m512i pattern = _mm512_set1_epi64(patternWord(span.bodyStart));
+
+    fillBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 64)
+    {
+        _mm512_stream_si512(reinterpret_cast<__m512i *>(buffer + i), pattern);
+    }
+
+    _mm_sfence();
+
+    fillBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("avx512f")))
+long long verifyAvx512(const char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 64);
+    const __m512i pattern = _mm512_set1_epi64(patternWord(span.bodyStart));
+    __m512i differences = _mm512_setzero_si512();
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 64)
+    {
+        __m512i data = _mm512_load_si512(reinterpret_cast<const __m512i *>(buffer + i));
+        differences = _mm512_or_si512(differences, _mm512_xor_si512(data, pattern));
+    }
+
+    bool hasDifferences = _mm512_test_epi64_mask(differences, differences) != 0;
+    long long mismatches = countBytes(buffer, startIndex, span.bodyStart) + countBytes(buffer, span.bodyEnd, finalIndex);
+
+    return mismatches + (hasDifferences ? countBytes(buffer, span.bodyStart, span.bodyEnd) : 0);
+}
+
+__attribute__((target("avx512f")))
+void invertAvx512(char * buffer, long long startIndex, long long finalIndex)
+{
+    AlignedSpan span = alignSpan(buffer, startIndex, finalIndex, 64);
+    const __m512i ones = _mm512_set1_epi32(-1);
+
+    invertBytes(buffer, startIndex, span.bodyStart);
+
+    for (long long i = span.bodyStart; i < span.bodyEnd; i += 64)
+    {
+        __m512i * data = reinterpret_cast<__m512i *>(buffer + i);
+        _mm512_store_si512(data, _mm512_xor_si512(_mm512_load_si512(data), ones));
+    }
+
+    invertBytes(buffer, span.bodyEnd, finalIndex);
+}
+
+__attribute__((target("avx512f")))
+void swapAvx512(char * first, char * second, long long length)
+{
+    long long vectorEnd = length / 64 * 64;
+
+    for (long long i = 0; i < vectorEnd; i += 64)
+    {
+        __m512i firstData = _mm512_loadu_si512(first + i);
+        __m512i secondData = _mm512_loadu_si512(second + i);
+
+        _mm512_storeu_si512(first + i, secondData);
+        _mm512_storeu_si512(second + i, firstData);
+    }
+
+    swapBytes(first, second, vectorEnd, length);
+}
+
+#endif // MEMSTRESS_X86_KERNELS
+
+KernelTable buildKernelTable(KernelIsa maxIsa)
+{
+    KernelTable table{fillGeneric, fillGeneric, verifyGeneric, invertGeneric, swapGeneric,
+        "generic", "generic", "generic", "generic", "generic"};
+
+    #ifdef MEMSTRESS_X86_KERNELS
+        const CpuFeatures& features = cpuFeatures();
+
+        if (features.sse2 && maxIsa >= KernelIsa::Sse2)
+        {
+            table = {fillSse2, fillSse2, verifySse2, invertSse2, swapSse2,
+                "sse2", "sse2", "sse2", "sse2", "sse2"};
+
+            if (features.nonTemporalStores)
+            {
+                table.fillStreaming = fillSse2Streaming;
+                table.fillStreamingName = "sse2-nt";
+            }
+        }
+
+        if (features.avx2 && maxIsa >= KernelIsa::Avx2)
+        {
+            table = {fillAvx2, fillAvx2Streaming, verifyAvx2, invertAvx2, swapAvx2,
+                "avx2", "avx2-nt", "avx2", "avx2", "avx2"};
+        }
+
+        if (features.avx512 && maxIsa >= KernelIsa::Avx512)
+        {
+            table = {fillAvx512, fillAvx512Streaming, verifyAvx512, invertAvx512, swapAvx512,
+                "avx512", "avx512-nt", "avx512", "avx512", "avx512"};
+        }
+    #else
+        (void) maxIsa;
+    #endif
+
+    return table;
+}
+
+// Escolha da thread atual, nula para usar os melhores kernels da CPU
+thread_local const KernelTable * threadKernels = nullptr;
+
+} // namespace
+
+const KernelTable& kernelsFor(KernelIsa maxIsa)
+{
+    // Uma tabela por limite, montadas uma vez e nunca alteradas, assim podem ser lidas por qualquer thread
+    static const KernelTable tables[] = {
+        buildKernelTable(KernelIsa::Generic),
+        buildKernelTable(KernelIsa::Sse2),
+        buildKernelTable(KernelIsa::Avx2),
+        buildKernelTable(KernelIsa::Avx512),
+        buildKernelTable(KernelIsa::Auto)};
+
+    return tables[static_cast<int>(maxIsa)];
+}
+
+void useKernels(const KernelTable& table)
+{
+    threadKernels = &table;
+}
+
+void selectKernels(KernelIsa maxIsa)
+{
+    useKernels(kernelsFor(maxIsa));
+}
+
+const KernelTable& activeKernels()
+{
+    return threadKernels ? *threadKernels : kernelsFor(KernelIsa::Auto);
+}
+
+std::string describeKernelSelection()
+{
+    const KernelTable& table = activeKernels();
+
+    return std::string("fill ") + table.fillName
+        + " (buffer grande: " + table.fillStreamingName + ")"
+        + ", verify " + table.verifyName
+        + ", invert " + table.invertName
+        + ", swap " + table.swapName;
+}
+
+} // namespace memstress
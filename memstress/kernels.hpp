@@ -0,0 +1,235 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+
+namespace memstress
+{
+
+// Kernels de estresse da memoria, usados pelo mem-stress e pelo benchmark.
+// Sao parametrizados pelo buffer e pela largura do acesso (T), as posicoes sao em elementos de T.
+
+// Valor do padrao alternado 0x55/0xAA na posicao, repetido em todos os bytes do elemento
+template <typename T>
+inline T patternValue(long long index)
+{
+    return index % 2 == 0
+        ? static_cast<T>(0x5555555555555555ULL)
+        : static_cast<T>(0xAAAAAAAAAAAAAAAAULL);
+}
+
+// Preenche a faixa do buffer com o padrao alternado
+template <typename T>
+inline void writePatternRange(volatile T * buffer, long long startIndex, long long finalIndex)
+{
+    for (long long i = startIndex; i < finalIndex; i++)
+    {
+        buffer[i] = patternValue<T>(i);
+    }
+}
+
+// Confere se a faixa ainda tem o padrao alternado, retorna a quantidade de posicoes erradas
+template <typename T>
+inline long long verifyPatternRange(volatile T * buffer, long long startIndex, long long finalIndex)
+{
+    long long mismatches = 0;
+
+    for (long long i = startIndex; i < finalIndex; i++)
+    {
+        mismatches += buffer[i] != patternValue<T>(i);
+    }
+
+    return mismatches;
+}
+
+// Inverte o valor binario da posicao e confere a escrita, retorna false se o valor lido estiver errado.
+// written recebe o valor escrito, sem reler a posicao (o trace guarda o valor a custo zero).
+template <typename T>
+inline bool invertPosition(volatile T * buffer, long long memoryPosition, T& written)
+{
+    T oldData = buffer[memoryPosition];
+
+    // Operador ~ inverte o valor binario
+    written = ~oldData;
+    buffer[memoryPosition] = written;
+
+    return buffer[memoryPosition] == written;
+}
+
+template <typename T>
+inline bool invertPosition(volatile T * buffer, long long memoryPosition)
+{
+    T written;
+    return invertPosition(buffer, memoryPosition, written);
+}
+
+// Troca o valor de duas posicoes e confere a escrita, retorna false se algum valor lido estiver errado.
+// firstWritten e secondWritten recebem os valores escritos em cada posicao.
+template <typename T>
+inline bool swapPositions(volatile T * buffer, long long firstMemoryPosition, long long secondMemoryPosition, T& firstWritten,
+    T& secondWritten)
+{
+    T firstDataInMemory = buffer[firstMemoryPosition];
+    T secondDataInMemory = buffer[secondMemoryPosition];
+
+    buffer[firstMemoryPosition] = secondDataInMemory;
+    buffer[secondMemoryPosition] = firstDataInMemory;
+
+    firstWritten = secondDataInMemory;
+    secondWritten = firstDataInMemory;
+
+    return buffer[firstMemoryPosition] == secondDataInMemory && buffer[secondMemoryPosition] == firstDataInMemory;
+}
+
+template <typename T>
+inline bool swapPositions(volatile T * buffer, long long firstMemoryPosition, long long secondMemoryPosition)
+{
+    T firstWritten;
+    T secondWritten;
+    return swapPositions(buffer, firstMemoryPosition, secondMemoryPosition, firstWritten, secondWritten);
+}
+
+// Kernels de blocos grandes, sem volatile para o compilador e as instrucoes vetoriais poderem agir.
+// Sao usados no preenchimento, na conferencia e nos kernels sequenciais, onde nao ha releitura logo
+// apos a escrita que o compilador possa eliminar. A implementacao de cada um eh escolhida em tempo de
+// execucao conforme os recursos da CPU (SSE2, AVX2, AVX-512, escritas non-temporal).
+
+// Conjunto de instrucoes maximo dos kernels de blocos, Auto usa o melhor que a CPU suporta
+enum class KernelIsa
+{
+    Generic,
+    Sse2,
+    Avx2,
+    Avx512,
+    Auto
+};
+
+// Implementacoes escolhidas para cada kernel de blocos, com o nome de cada uma para o relatorio
+struct KernelTable
+{
+    void (*fill)(char *, long long, long long);
+    void (*fillStreaming)(char *, long long, long long);
+    long long (*verify)(const char *, long long, long long);
+    void (*invert)(char *, long long, long long);
+    void (*swap)(char *, char *, long long);
+
+    const char * fillName;
+    const char * fillStreamingName;
+    const char * verifyName;
+    const char * invertName;
+    const char * swapName;
+};
+
+// Kernels mais rapidos suportados pela CPU ate o limite pedido
+const KernelTable& kernelsFor(KernelIsa maxIsa);
+
+// A escolha dos kernels vale para a thread atual e as threads que ela cria pelo runParallel, assim duas
+// sessoes no mesmo processo usam cada uma os seus kernels. Sem escolha a thread usa os melhores da CPU.
+void useKernels(const KernelTable& table);
+
+// Escolhe os kernels mais rapidos suportados pela CPU ate o limite pedido para a thread atual.
+// Deve ser chamado antes de iniciar as threads que usam os kernels.
+void selectKernels(KernelIsa maxIsa);
+
+// Kernels da thread atual
+const KernelTable& activeKernels();
+
+// Kernels escolhidos, para mostrar ao usuario
+std::string describeKernelSelection();
+
+// Preenche a faixa (em bytes) com o padrao alternado 0x55/0xAA
+inline void fillPattern(char * buffer, long long startIndex, long long finalIndex)
+{
+    activeKernels().fill(buffer, startIndex, finalIndex);
+}
+
+// Igual ao fillPattern mas com escritas non-temporal, para faixas bem maiores que a cache
+inline void fillPatternStreaming(char * buffer, long long startIndex, long long finalIndex)
+{
+    activeKernels().fillStreaming(buffer, startIndex, finalIndex);
+}
+
+// Quantidade de bytes da faixa que nao tem o padrao alternado
+inline long long countPatternMismatches(const char * buffer, long long startIndex, long long finalIndex)
+{
+    return activeKernels().verify(buffer, startIndex, finalIndex);
+}
+
+// Inverte todos os bits da faixa
+inline void invertBlock(char * buffer, long long startIndex, long long finalIndex)
+{
+    activeKernels().invert(buffer, startIndex, finalIndex);
+}
+
+// Troca o conteudo de dois blocos de mesmo tamanho que nao se sobrepoem
+inline void swapBlocks(char * first, char * second, long long length)
+{
+    activeKernels().swap(first, second, length);
+}
+
+// Mistura do splitmix64, espalha bits proximos de uma entrada por toda a saida
+inline uint64_t mixBits(uint64_t value)
+{
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// Semente da sequencia de uma thread derivada da semente da execucao, 0 sorteia pelo random_device
+inline uint64_t streamSeed(uint64_t seed, int stream)
+{
+    if (seed == 0) return (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+
+    return mixBits(seed + mixBits(static_cast<uint64_t>(stream) + 1));
+}
+
+// Gerador das posicoes aleatorias das threads de estresse. Eh baseado em contador (splitmix64): o n-esimo
+// sorteio depende so da semente e de n, entao saltar para qualquer ponto da sequencia custa O(1), e cada
+// posicao consome exatamente um sorteio, sem a rejeicao do uniform_int_distribution.
+class AddressGenerator
+{
+public:
+    AddressGenerator(long long startIndex, long long finalIndex, uint64_t seed)
+        : seed(seed), counter(0), startIndex(startIndex), range(static_cast<uint64_t>(finalIndex - startIndex))
+    {
+    }
+
+    long long next()
+    {
+        uint64_t value = mixBits(seed + ++counter * 0x9E3779B97F4A7C15ULL);
+
+        // Reducao multiplicativa para a faixa, o vies eh desprezivel para faixas bem menores que 2^64
+        #ifdef __SIZEOF_INT128__
+            return startIndex + static_cast<long long>((static_cast<unsigned __int128>(value) * range) >> 64);
+        #else
+            return startIndex + static_cast<long long>(value % range);
+        #endif
+    }
+
+    // Sorteios feitos ate agora, a posicao na sequencia
+    uint64_t position() const { return counter; }
+
+    void jump(uint64_t position) { counter = position; }
+
+    // Estado do gerador em texto ("semente posicao"), para o checkpoint continuar a mesma sequencia
+    std::string state() const
+    {
+        return std::to_string(seed) + " " + std::to_string(counter);
+    }
+
+    bool restore(const std::string& state)
+    {
+        std::istringstream text(state);
+        return static_cast<bool>(text >> seed >> counter);
+    }
+
+private:
+    uint64_t seed;
+    uint64_t counter;
+    long long startIndex;
+    uint64_t range;
+};
+
+} // namespace memstress
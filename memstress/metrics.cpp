@@ -0,0 +1,247 @@
+#include "memstress/metrics.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+namespace memstress
+{
+
+namespace
+{
+
+// Tempo maximo de espera por uma conexao antes de conferir o pedido de parada
+const int acceptPollMillis = 200;
+
+// Cabecalho HELP/TYPE de uma metrica
+void describeMetric(std::ostream& out, const char * name, const char * type, const char * help)
+{
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+long long loadRelaxed(const std::atomic<long long>& counter)
+{
+    return counter.load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+std::string formatStressMetrics(const std::vector<ThreadStats>& stats, const std::vector<int>& placement,
+    const TelemetrySample& sample, bool running)
+{
+    std::ostringstream out;
+    out.precision(12);
+
+    // Rotulos de cada thread, com a CPU quando as threads foram presas
+    std::vector<std::string> labels;
+
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        std::string label = "thread=\"" + std::to_string(i) + "\"";
+        if (!placement.empty()) label += ",cpu=\"" + std::to_string(placement[i % placement.size()]) + "\"";
+        labels.push_back(label);
+    }
+
+    auto total = [&](std::atomic<long long> ThreadStats::* counter) {
+        long long sum = 0;
+        for (const ThreadStats& threadStats : stats) sum += loadRelaxed(threadStats.*counter);
+        return sum;
+    };
+
+    auto perThread = [&](const char * name, const char * help, std::atomic<long long> ThreadStats::* counter) {
+        describeMetric(out, name, "counter", help);
+        for (size_t i = 0; i < stats.size(); i++) out << name << "{" << labels[i] << "} " << loadRelaxed(stats[i].*counter) << "\n";
+    };
+
+    describeMetric(out, "memstress_running", "gauge", "1 enquanto o estresse executa, 0 no resultado final");
+    out << "memstress_running " << (running ? 1 : 0) << "\n";
+
+    describeMetric(out, "memstress_elapsed_seconds", "gauge", "Segundos desde o inicio do estresse");
+    out << "memstress_elapsed_seconds " << sample.seconds << "\n";
+
+    describeMetric(out, "memstress_operations_total", "counter", "Operacoes conferidas de todas as threads");
+    out << "memstress_operations_total " << total(&ThreadStats::operations) << "\n";
+
+    describeMetric(out, "memstress_errors_total", "counter", "Escritas que nao conferiram");
+    out << "memstress_errors_total " << total(&ThreadStats::errors) << "\n";
+
+    describeMetric(out, "memstress_read_bytes_total", "counter", "Bytes lidos, incluindo a releitura de conferencia");
+    out << "memstress_read_bytes_total " << total(&ThreadStats::bytesRead) << "\n";
+
+    describeMetric(out, "memstress_written_bytes_total", "counter", "Bytes escritos");
+    out << "memstress_written_bytes_total " << total(&ThreadStats::bytesWritten) << "\n";
+
+    describeMetric(out, "memstress_quarantined_pages_total", "counter", "Paginas isoladas pela quarentena");
+    out << "memstress_quarantined_pages_total " << total(&ThreadStats::quarantinedPages) << "\n";
+
+    describeMetric(out, "memstress_operations_per_second", "gauge", "Operacoes por segundo no ultimo intervalo");
+    out << "memstress_operations_per_second " << sample.opsPerSecond << "\n";
+
+    describeMetric(out, "memstress_bandwidth_bytes_per_second", "gauge", "Bytes lidos e escritos por segundo no ultimo intervalo");
+    out << "memstress_bandwidth_bytes_per_second " << sample.gbps * 1e9 << "\n";
+
+    // O Prometheus espera faixas cumulativas em segundos
+    describeMetric(out, "memstress_operation_latency_seconds", "histogram", "Latencia da operacao amostrada em cada lote");
+
+    long long cumulative = 0;
+    long long latencySum = total(&ThreadStats::latencySumNanos);
+
+    for (int bucket = 0; bucket < latencyBucketCount; bucket++)
+    {
+        for (const ThreadStats& threadStats : stats) cumulative += loadRelaxed(threadStats.latencyBuckets[bucket]);
+
+        out << "memstress_operation_latency_seconds_bucket{le=\"";
+        if (bucket < latencyBucketCount - 1) out << latencyBucketBounds[bucket] / 1e9; else out << "+Inf";
+        out << "\"} " << cumulative << "\n";
+    }
+
+    out << "memstress_operation_latency_seconds_sum " << latencySum / 1e9 << "\n";
+    out << "memstress_operation_latency_seconds_count " << cumulative << "\n";
+
+    perThread("memstress_thread_operations_total", "Operacoes conferidas pela thread", &ThreadStats::operations);
+    perThread("memstress_thread_errors_total", "Escritas que nao conferiram na thread", &ThreadStats::errors);
+    perThread("memstress_thread_read_bytes_total", "Bytes lidos pela thread", &ThreadStats::bytesRead);
+    perThread("memstress_thread_written_bytes_total", "Bytes escritos pela thread", &ThreadStats::bytesWritten);
+
+    describeMetric(out, "memstress_thread_max_latency_seconds", "gauge", "Maior latencia amostrada na thread");
+    for (size_t i = 0; i < stats.size(); i++) out << "memstress_thread_max_latency_seconds{" << labels[i] << "} " << loadRelaxed(stats[i].maxLatencyNanos) / 1e9 << "\n";
+
+    // Telemetria so quando a fonte existe na maquina
+    auto gauge = [&](const char * name, const char * help, double value) {
+        if (value <= 0) return;
+        describeMetric(out, name, "gauge", help);
+        out << name << " " << value << "\n";
+    };
+
+    gauge("memstress_cpu_frequency_hertz", "Frequencia media atual das CPUs", sample.cpuMhz * 1e6);
+    gauge("memstress_cpu_min_frequency_hertz", "Menor frequencia atual entre as CPUs", sample.minCpuMhz * 1e6);
+    gauge("memstress_package_temperature_celsius", "Maior temperatura entre os pacotes", sample.packageCelsius);
+    gauge("memstress_dimm_temperature_celsius", "Maior temperatura entre os DIMMs", sample.dramCelsius);
+    gauge("memstress_package_power_watts", "Potencia do pacote no ultimo intervalo (RAPL)", sample.packageWatts);
+    gauge("memstress_dram_power_watts", "Potencia da DRAM no ultimo intervalo (RAPL)", sample.dramWatts);
+
+    return out.str();
+}
+
+MetricsExporter::MetricsExporter(std::string filePath, int port)
+    : filePath(std::move(filePath)), stopRequested(false)
+{
+    if (port <= 0) return;
+
+    #ifdef __linux__
+        listenSocket = socket(AF_INET, SOCK_STREAM, 0);
+
+        int reuse = 1;
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_ANY);
+        address.sin_port = htons(static_cast<uint16_t>(port));
+
+        if (listenSocket < 0
+            || setsockopt(listenSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0
+            || bind(listenSocket, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+            || listen(listenSocket, 16) != 0)
+        {
+            firstError = "porta " + std::to_string(port) + ": " + std::strerror(errno);
+
+            if (listenSocket >= 0) close(listenSocket);
+            listenSocket = -1;
+            return;
+        }
+
+        server = std::thread(&MetricsExporter::serve, this);
+    #else
+        firstError = "endpoint HTTP disponível apenas no Linux";
+    #endif
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    stopRequested.store(true);
+    if (server.joinable()) server.join();
+
+    #ifdef __linux__
+        if (listenSocket >= 0) close(listenSocket);
+    #endif
+}
+
+void MetricsExporter::publish(const std::string& text)
+{
+    {
+        std::lock_guard<std::mutex> lock(textMutex);
+        currentText = text;
+    }
+
+    if (filePath.empty()) return;
+
+    std::string temporaryPath = filePath + ".tmp";
+
+    {
+        std::ofstream file(temporaryPath, std::ios::trunc);
+        file << text;
+
+        if (!file && firstError.empty()) firstError = temporaryPath + ": " + std::strerror(errno);
+    }
+
+    if (std::rename(temporaryPath.c_str(), filePath.c_str()) != 0 && firstError.empty())
+    {
+        firstError = filePath + ": " + std::strerror(errno);
+    }
+}
+
+// Servidor HTTP minimo: uma conexao por vez, responde qualquer pedido com as metricas e fecha
+void MetricsExporter::serve()
+{
+    #ifdef __linux__
+        while (!stopRequested.load())
+        {
+            pollfd listener{listenSocket, POLLIN, 0};
+            if (poll(&listener, 1, acceptPollMillis) <= 0) continue;
+
+            int connection = accept(listenSocket, nullptr, nullptr);
+            if (connection < 0) continue;
+
+            // O pedido nao importa, mas eh lido para o cliente nao receber um reset ao fechar
+            timeval timeout{1, 0};
+            setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+            char request[4096];
+            if (recv(connection, request, sizeof(request), 0) < 0)
+            {
+                close(connection);
+                continue;
+            }
+
+            std::string body;
+
+            {
+                std::lock_guard<std::mutex> lock(textMutex);
+                body = currentText;
+            }
+
+            std::string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                + std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+
+            for (size_t sent = 0; sent < response.size();)
+            {
+                ssize_t written = send(connection, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (written <= 0) break;
+                sent += written;
+            }
+
+            close(connection);
+        }
+    #endif
+}
+
+} // namespace memstress
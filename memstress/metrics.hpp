@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "memstress/stats.hpp"
+#include "memstress/telemetry.hpp"
+
+namespace memstress
+{
+
+// Metricas do estresse no formato texto do Prometheus: totais, vazao do intervalo, histograma de latencia,
+// contadores por thread (com a CPU quando presa) e a telemetria disponivel
+std::string formatStressMetrics(const std::vector<ThreadStats>& stats, const std::vector<int>& placement,
+    const TelemetrySample& sample, bool running);
+
+// Publica as metricas em um arquivo para o textfile collector do node_exporter e/ou em um endpoint HTTP
+// (GET em qualquer caminho devolve o texto mais recente). Porta 0 e arquivo vazio desativam cada saida.
+class MetricsExporter
+{
+public:
+    MetricsExporter(std::string filePath, int port);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    bool enabled() const { return !filePath.empty() || listenSocket >= 0; }
+
+    // Troca o texto servido e reescreve o arquivo. O arquivo eh escrito em um temporario e renomeado,
+    // assim o coletor nunca le um arquivo pela metade.
+    void publish(const std::string& text);
+
+    // Primeira falha ao abrir a porta ou escrever o arquivo, vazio se tudo deu certo
+    const std::string& error() const { return firstError; }
+
+private:
+    void serve();
+
+    std::string filePath;
+    std::string firstError;
+
+    int listenSocket = -1;
+    std::atomic<bool> stopRequested;
+    std::thread server;
+
+    std::mutex textMutex;
+    std::string currentText;
+};
+
+} // namespace memstress
@@ -0,0 +1,338 @@
+#include "memstress/mixed.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iomanip>
+#include <thread>
+#include "memstress/kernels.hpp"
+#include "memstress/system.hpp"
+
+namespace memstress
+{
+
+namespace
+{
+
+// Operacoes entre as conferencias do prazo e as atualizacoes dos contadores
+const int mixedOpsBatch = 1024;
+
+// Falhas guardadas por thread, o mesmo limite do estresse
+const size_t mixedFaultsPerThread = 32;
+
+// Termos da soma exata do zeta, o resto eh aproximado pela integral
+const long long zetaExactTerms = 1 << 20;
+
+const uint64_t golden = 0x9E3779B97F4A7C15ULL;
+
+// Palavra alinhada do preenchimento 0x55/0xAA, o conteudo de uma posicao ainda nao escrita
+uint64_t fillWord()
+{
+    char bytes[sizeof(uint64_t)];
+    uint64_t word;
+
+    for (long long i = 0; i < static_cast<long long>(sizeof(uint64_t)); i++) bytes[i] = patternValue<char>(i);
+
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+// Palavra escrita na posicao: o valor aleatorio na metade baixa e na alta uma assinatura dele com a posicao,
+// assim uma palavra corrompida ou gravada no endereco errado nao confere
+inline uint64_t signedWord(long long wordIndex, uint32_t value)
+{
+    return (mixBits(static_cast<uint64_t>(wordIndex) * golden + value) & 0xFFFFFFFF00000000ULL) | value;
+}
+
+inline bool validWord(long long wordIndex, uint64_t word, uint64_t untouched)
+{
+    return word == untouched || word == signedWord(wordIndex, static_cast<uint32_t>(word));
+}
+
+// Sorteio do zipfian pelo metodo de Gray et al. (o do YCSB), o rank 0 eh o mais acessado
+class ZipfianGenerator
+{
+public:
+    ZipfianGenerator(long long itemCount, double theta)
+        : itemCount(itemCount), alpha(1 / (1 - theta))
+    {
+        zetaN = zeta(itemCount, theta);
+        double zeta2 = zeta(2, theta);
+        eta = (1 - std::pow(2.0 / itemCount, 1 - theta)) / (1 - zeta2 / zetaN);
+        secondThreshold = 1 + std::pow(0.5, theta);
+    }
+
+    long long next(double uniform) const
+    {
+        double scaled = uniform * zetaN;
+
+        if (scaled < 1) return 0;
+        if (scaled < secondThreshold) return std::min<long long>(1, itemCount - 1);
+
+        long long rank = static_cast<long long>(itemCount * std::pow(eta * uniform - eta + 1, alpha));
+        return std::min(rank, itemCount - 1);
+    }
+
+private:
+    // Soma exata dos primeiros termos e integral com correcao de meio ponto no resto, a soma exata de
+    // bilhoes de posicoes atrasaria o inicio em segundos
+    static double zeta(long long count, double theta)
+    {
+        long long exact = std::min(count, zetaExactTerms);
+        double sum = 0;
+
+        for (long long i = 1; i <= exact; i++) sum += 1 / std::pow(static_cast<double>(i), theta);
+
+        if (count > exact)
+        {
+            sum += (std::pow(count + 0.5, 1 - theta) - std::pow(exact + 0.5, 1 - theta)) / (1 - theta);
+        }
+
+        return sum;
+    }
+
+    long long itemCount;
+    double alpha;
+    double zetaN;
+    double eta;
+    double secondThreshold;
+};
+
+struct MixedThreadResult
+{
+    long long reads = 0;
+    long long writes = 0;
+    std::vector<FaultRecord> faults;
+};
+
+void mixedThread(volatile char * buffer, int thread, Range range, const MixedWorkload& workload, uint64_t seed,
+    const RunDeadline& deadline, std::chrono::steady_clock::time_point startTime, ThreadStats& stats, MixedThreadResult& result)
+{
+    const long long width = workload.width;
+    const long long wordsPerAccess = width / static_cast<long long>(sizeof(uint64_t));
+    const long long slotCount = (range.finalIndex - range.startIndex) / width;
+
+    if (slotCount <= 0) return;
+
+    const uint64_t untouched = fillWord();
+
+    // Limite da proporcao de leituras em 32 bits, comparado com a metade baixa do sorteio de cada operacao
+    const uint64_t readThreshold = (static_cast<uint64_t>(workload.readPercent) << 32) / 100;
+
+    const long long strideSlots = std::min(slotCount, std::max(1LL, workload.stride / width));
+
+    AddressGenerator slotGenerator(0, slotCount, mixBits(seed + 1));
+    ZipfianGenerator zipfian(workload.pattern == AccessPattern::Zipfian ? slotCount : 2, workload.zipfTheta);
+    const uint64_t hotSalt = mixBits(seed + 2);
+
+    uint64_t counter = 0;
+    long long slot = 0;
+    long long lane = 0;
+
+    auto nextSlot = [&]() -> long long {
+        switch (workload.pattern)
+        {
+            case AccessPattern::Sequential:
+                if (++slot == slotCount) slot = 0;
+                return slot;
+
+            case AccessPattern::Strided:
+                slot += strideSlots;
+
+                if (slot >= slotCount)
+                {
+                    lane = (lane + 1) % strideSlots;
+                    slot = lane;
+                }
+                return slot;
+
+            case AccessPattern::Zipfian:
+            {
+                double uniform = (mixBits(seed + ++counter * golden) >> 11) * 0x1.0p-53;
+                uint64_t hashed = mixBits(static_cast<uint64_t>(zipfian.next(uniform)) ^ hotSalt);
+
+                // Os ranks quentes sao espalhados pela faixa, como as chaves quentes de um indice hash
+                #ifdef __SIZEOF_INT128__
+                    return static_cast<long long>((static_cast<unsigned __int128>(hashed) * slotCount) >> 64);
+                #else
+                    return static_cast<long long>(hashed % slotCount);
+                #endif
+            }
+
+            default:
+                return slotGenerator.next();
+        }
+    };
+
+    auto recordFault = [&](long long memoryPosition) {
+        if (result.faults.size() >= mixedFaultsPerThread) return;
+
+        FaultRecord fault;
+        fault.thread = thread;
+        fault.offset = memoryPosition;
+        fault.virtualAddress = reinterpret_cast<uintptr_t>(buffer + memoryPosition);
+        fault.physicalAddress = physicalAddressOf(buffer + memoryPosition);
+        fault.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        result.faults.push_back(fault);
+    };
+
+    // O sequencial e o strided comecam na primeira posicao
+    slot = workload.pattern == AccessPattern::Strided ? -strideSlots : -1;
+
+    while (!deadline.expired())
+    {
+        long long reads = 0;
+        long long errors = 0;
+
+        for (int i = 0; i < mixedOpsBatch; i++)
+        {
+            long long memoryPosition = range.startIndex + nextSlot() * width;
+            long long wordIndex = memoryPosition / static_cast<long long>(sizeof(uint64_t));
+            volatile uint64_t * words = reinterpret_cast<volatile uint64_t *>(buffer + memoryPosition);
+
+            uint64_t draw = mixBits(seed + ++counter * golden);
+
+            if ((draw & 0xFFFFFFFFULL) < readThreshold)
+            {
+                reads++;
+
+                for (long long k = 0; k < wordsPerAccess; k++)
+                {
+                    if (!validWord(wordIndex + k, words[k], untouched))
+                    {
+                        errors++;
+                        recordFault(memoryPosition + k * static_cast<long long>(sizeof(uint64_t)));
+                    }
+                }
+            } else {
+                uint32_t value = static_cast<uint32_t>(draw >> 32);
+
+                for (long long k = 0; k < wordsPerAccess; k++) words[k] = signedWord(wordIndex + k, value + static_cast<uint32_t>(k));
+
+                // Releitura de conferencia, depois de escrever o acesso inteiro como faria a aplicacao
+                for (long long k = 0; k < wordsPerAccess; k++)
+                {
+                    if (words[k] != signedWord(wordIndex + k, value + static_cast<uint32_t>(k)))
+                    {
+                        errors++;
+                        recordFault(memoryPosition + k * static_cast<long long>(sizeof(uint64_t)));
+                    }
+                }
+            }
+        }
+
+        long long writes = mixedOpsBatch - reads;
+
+        result.reads += reads;
+        result.writes += writes;
+
+        ThreadStats::add(stats.operations, mixedOpsBatch);
+        ThreadStats::add(stats.bytesRead, (reads + writes) * width);
+        ThreadStats::add(stats.bytesWritten, writes * width);
+        ThreadStats::add(stats.errors, errors);
+    }
+}
+
+} // namespace
+
+const char * accessPatternName(AccessPattern pattern)
+{
+    switch (pattern)
+    {
+        case AccessPattern::Sequential: return "sequential";
+        case AccessPattern::Strided: return "strided";
+        case AccessPattern::Zipfian: return "zipfian";
+        default: return "random";
+    }
+}
+
+MixedSummary runMixed(Buffer& buffer, int threadCount, const std::vector<int>& placement, const RunDeadline& deadline,
+    const MixedWorkload& workload, uint64_t seed, int reportSeconds, std::ostream * output)
+{
+    MixedSummary summary;
+
+    if (output)
+    {
+        *output << "\nCarga mista: " << workload.readPercent << "% leituras, padrão " << accessPatternName(workload.pattern)
+            << ", acessos de " << workload.width << " bytes" << std::endl;
+    }
+
+    std::vector<ThreadStats> stats(threadCount);
+    std::vector<MixedThreadResult> results(threadCount);
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::thread reporter([&]() {
+        long long lastOperations = 0;
+        long long lastBytes = 0;
+        auto lastReport = startTime;
+
+        while (!deadline.expired())
+        {
+            deadline.waitUntil(lastReport + std::chrono::seconds(reportSeconds));
+
+            auto now = std::chrono::steady_clock::now();
+            long long operations = 0;
+            long long bytes = 0;
+            long long errors = 0;
+
+            for (const ThreadStats& threadStats : stats)
+            {
+                operations += threadStats.operations.load(std::memory_order_relaxed);
+                bytes += threadStats.bytesRead.load(std::memory_order_relaxed) + threadStats.bytesWritten.load(std::memory_order_relaxed);
+                errors += threadStats.errors.load(std::memory_order_relaxed);
+            }
+
+            std::chrono::duration<double> interval = now - lastReport;
+            std::chrono::duration<double> elapsed = now - startTime;
+
+            if (output)
+            {
+                std::ios::fmtflags flags = output->flags();
+                std::streamsize precision = output->precision();
+
+                *output << "[" << std::fixed << std::setprecision(1) << elapsed.count() << " s] "
+                    << std::setprecision(0) << (operations - lastOperations) / interval.count() << " ops/s, "
+                    << std::setprecision(2) << (bytes - lastBytes) / interval.count() / 1e9 << " GB/s, erros: " << errors << std::endl;
+
+                output->flags(flags);
+                output->precision(precision);
+            }
+
+            lastOperations = operations;
+            lastBytes = bytes;
+            lastReport = now;
+        }
+    });
+
+    runParallel(threadCount, [&](int index) {
+        // Faixas alinhadas na linha de cache, nenhum acesso cruza a faixa de outra thread
+        Range range = partitionRange(buffer.size(), threadCount, index, 64);
+
+        mixedThread(buffer.data(), index, range, workload, streamSeed(seed, index), deadline, startTime, stats[index], results[index]);
+    }, placement);
+
+    reporter.join();
+
+    std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - startTime;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        summary.reads += results[i].reads;
+        summary.writes += results[i].writes;
+        summary.errors += stats[i].errors.load();
+        summary.bytes += stats[i].bytesRead.load() + stats[i].bytesWritten.load();
+
+        summary.faults.insert(summary.faults.end(), results[i].faults.begin(), results[i].faults.end());
+    }
+
+    summary.opsPerSecond = (summary.reads + summary.writes) / totalTime.count();
+    summary.gbps = summary.bytes / totalTime.count() / 1e9;
+
+    return summary;
+}
+
+} // namespace memstress
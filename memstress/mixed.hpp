@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "memstress/buffer.hpp"
+#include "memstress/parallel.hpp"
+#include "memstress/stats.hpp"
+
+namespace memstress
+{
+
+// Ordem das posicoes acessadas pela carga mista, dentro da faixa de cada thread
+enum class AccessPattern
+{
+    Random,     // uniforme na faixa
+    Sequential, // posicoes consecutivas, voltando ao inicio no final
+    Strided,    // saltos de stride bytes, deslocando o inicio a cada volta
+    Zipfian     // poucas posicoes quentes concentram os acessos, espalhadas pela faixa
+};
+
+// Carga mista: proporcao de leituras, padrao e largura de cada acesso
+struct MixedWorkload
+{
+    // Porcentagem das operacoes que so leem, o resto escreve
+    int readPercent = 80;
+
+    AccessPattern pattern = AccessPattern::Random;
+
+    // Bytes de cada acesso, multiplo de 8 ate 64 (uma linha de cache)
+    int width = 8;
+
+    // Salto do padrao strided em bytes
+    long long stride = 4096;
+
+    // Inclinacao do zipfian entre 0 e 1, 0.99 eh o padrao do YCSB
+    double zipfTheta = 0.99;
+};
+
+// Resultado do modo misto
+struct MixedSummary
+{
+    long long reads = 0;
+    long long writes = 0;
+    long long errors = 0;
+
+    // Bytes lidos e escritos, a releitura de conferencia das escritas inclusa
+    long long bytes = 0;
+
+    double opsPerSecond = 0;
+    double gbps = 0;
+
+    // Falhas de cada thread, ate o mesmo limite do estresse
+    std::vector<FaultRecord> faults;
+};
+
+// Modo misto: cada thread faz leituras e escritas na proporcao pedida sobre a sua faixa do buffer, no padrao
+// e largura pedidos, ate o prazo. Cada palavra escrita carrega um valor aleatorio e uma assinatura dele com a
+// propria posicao, entao toda leitura confere a palavra (valor do preenchimento ou assinatura valida) e cada
+// escrita eh relida. As threads ficam nas CPUs de placement (vazio sem afinidade). Seed 0 sorteia as
+// posicoes, outro valor as repete. Se output nao for nulo, a vazao e os erros sao escritos a cada intervalo.
+MixedSummary runMixed(Buffer& buffer, int threadCount, const std::vector<int>& placement, const RunDeadline& deadline,
+    const MixedWorkload& workload, uint64_t seed, int reportSeconds, std::ostream * output);
+
+// "random", "sequential", "strided" ou "zipfian"
+const char * accessPatternName(AccessPattern pattern);
+
+} // namespace memstress
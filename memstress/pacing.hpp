@@ -0,0 +1,53 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace memstress
+{
+
+// Controle de ritmo por token bucket. Os tokens sao bytes, operacoes ou alocacoes conforme o modo,
+// e o acumulo eh limitado para a thread nao compensar atrasos com rajadas longas.
+class TokenBucket
+{
+public:
+    TokenBucket(double ratePerSecond, double burst)
+        : ratePerSecond(ratePerSecond), burst(burst), tokens(0), lastRefill(std::chrono::steady_clock::now())
+    {
+    }
+
+    // Bloqueia ate haver tokens suficientes para o custo da proxima operacao
+    void acquire(double cost)
+    {
+        // Taxa zero significa sem limite
+        if (ratePerSecond <= 0) return;
+
+        refill();
+
+        if (tokens < cost)
+        {
+            std::this_thread::sleep_for(std::chrono::duration<double>((cost - tokens) / ratePerSecond));
+            refill();
+        }
+
+        tokens -= cost;
+    }
+
+private:
+    void refill()
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - lastRefill;
+
+        tokens = std::min(burst, tokens + elapsed.count() * ratePerSecond);
+        lastRefill = now;
+    }
+
+    double ratePerSecond;
+    double burst;
+    double tokens;
+    std::chrono::time_point<std::chrono::steady_clock> lastRefill;
+};
+
+} // namespace memstress
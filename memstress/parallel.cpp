@@ -0,0 +1,59 @@
+#include "memstress/parallel.hpp"
+
+#include <thread>
+#include <vector>
+#include "memstress/kernels.hpp"
+
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+namespace memstress
+{
+
+namespace
+{
+
+// Prende a thread atual na CPU, se nao conseguir a thread continua onde o escalonador quiser
+void pinCurrentThread(int cpu)
+{
+    #ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    #else
+        (void)cpu;
+    #endif
+}
+
+} // namespace
+
+void runParallel(int threadCount, const std::function<void(int)>& work, const std::vector<int>& placement)
+{
+    std::vector<std::thread> threads;
+
+    // As threads herdam os kernels escolhidos por quem as criou
+    const KernelTable& kernels = activeKernels();
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        // Prende antes de trabalhar, assim o primeiro toque nas paginas ja acontece no no NUMA da CPU
+        int cpu = placement.empty() ? -1 : placement[i % placement.size()];
+
+        threads.push_back(std::thread([&work, &kernels, i, cpu]() {
+            if (cpu >= 0) pinCurrentThread(cpu);
+            useKernels(kernels);
+            work(i);
+        }));
+    }
+
+    // Impede que a fase termine antes das threads finalizarem
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+} // namespace memstress
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace memstress
+{
+
+// Faixa [startIndex, finalIndex) do buffer
+struct Range
+{
+    long long startIndex;
+    long long finalIndex;
+};
+
+// Divide [0, size) em faixas alinhadas, a ultima faixa vai ate o final
+inline Range partitionRange(long long size, int parts, int index, long long alignment = 1)
+{
+    long long partSize = (size / parts) / alignment * alignment;
+
+    return {index * partSize, index == parts - 1 ? size : (index + 1) * partSize};
+}
+
+// Roda work(indice) em threadCount threads e espera todas terminarem. Cada thread eh presa na CPU do seu
+// indice em placement (repetindo a lista se faltar), vazio para nao prender.
+void runParallel(int threadCount, const std::function<void(int)>& work, const std::vector<int>& placement = {});
+
+// Prazo de uma fase, que tambem expira quando a sessao pede para parar
+class RunDeadline
+{
+public:
+    RunDeadline(std::chrono::time_point<std::chrono::steady_clock> finishTime, const std::atomic<bool>& stopRequested)
+        : finish(finishTime), stopRequested(&stopRequested)
+    {
+    }
+
+    bool expired() const
+    {
+        return stopRequested->load(std::memory_order_relaxed) || std::chrono::steady_clock::now() >= finish;
+    }
+
+    std::chrono::time_point<std::chrono::steady_clock> finishTime() const
+    {
+        return finish;
+    }
+
+    // Dorme ate o instante pedido, acordando antes se o prazo expirar
+    void waitUntil(std::chrono::time_point<std::chrono::steady_clock> wakeTime) const
+    {
+        const std::chrono::milliseconds pollTime(50);
+
+        wakeTime = std::min(wakeTime, finish);
+
+        while (!stopRequested->load(std::memory_order_relaxed) && wakeTime > std::chrono::steady_clock::now())
+        {
+            std::this_thread::sleep_until(std::min(wakeTime, std::chrono::steady_clock::now() + pollTime));
+        }
+    }
+
+private:
+    std::chrono::time_point<std::chrono::steady_clock> finish;
+    const std::atomic<bool> * stopRequested;
+};
+
+} // namespace memstress
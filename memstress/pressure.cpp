@@ -0,0 +1,138 @@
+#include "memstress/pressure.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iomanip>
+#include <random>
+#include "memstress/kernels.hpp"
+#include "memstress/pacing.hpp"
+
+namespace memstress
+{
+
+namespace
+{
+
+// Tamanho do bloco lido e escrito a cada token no modo banda
+const long long pressureChunkSize = 64 * 1024;
+
+// Operacoes aleatorias feitas a cada token no modo aleatorio
+const int pressureOpsBatch = 256;
+
+// Gera banda de memoria no ritmo pedido invertendo blocos da faixa da thread em sequencia
+void pressureBandwidthThread(volatile char * buffer, Range range, const RunDeadline& deadline, double bytesPerSecond, std::atomic<long long>& progress)
+{
+    long long chunkSize = std::min(pressureChunkSize, range.finalIndex - range.startIndex);
+
+    // Cada bloco eh lido e escrito, por isso o custo eh o dobro do tamanho
+    double chunkCost = chunkSize * 2.0;
+
+    // Acumulo maximo de ~2 ms de banda, no minimo um bloco
+    TokenBucket bucket(bytesPerSecond, std::max(chunkCost, bytesPerSecond * 0.002));
+
+    long long position = range.startIndex;
+
+    while (!deadline.expired())
+    {
+        bucket.acquire(chunkCost);
+
+        if (position + chunkSize > range.finalIndex) position = range.startIndex;
+
+        invertBlock(const_cast<char *>(buffer), position, position + chunkSize);
+
+        position += chunkSize;
+        progress.fetch_add(chunkSize * 2, std::memory_order_relaxed);
+    }
+}
+
+// Gera operacoes aleatorias no ritmo pedido, invertendo posicoes aleatorias da faixa da thread
+void pressureRandomThread(volatile char * buffer, Range range, uint64_t seed, const RunDeadline& deadline, double opsPerSecond, std::atomic<long long>& progress)
+{
+    AddressGenerator memPositionGenerator(range.startIndex, range.finalIndex, seed);
+
+    TokenBucket bucket(opsPerSecond, std::max<double>(pressureOpsBatch, opsPerSecond * 0.002));
+
+    while (!deadline.expired())
+    {
+        bucket.acquire(pressureOpsBatch);
+
+        for (int i = 0; i < pressureOpsBatch; i++)
+        {
+            long long memoryPosition = memPositionGenerator.next();
+            buffer[memoryPosition] = ~buffer[memoryPosition];
+        }
+
+        progress.fetch_add(pressureOpsBatch, std::memory_order_relaxed);
+    }
+}
+
+} // namespace
+
+PressureSummary runPressure(Buffer& buffer, int threadCount, const std::vector<int>& placement, const RunDeadline& deadline,
+    double targetGbps, double targetOps, uint64_t seed, int reportSeconds, std::ostream * output)
+{
+    PressureSummary summary;
+    summary.bandwidthMode = targetGbps > 0;
+    summary.target = summary.bandwidthMode ? targetGbps * 1e9 : targetOps;
+
+    double targetPerThread = summary.target / threadCount;
+    std::atomic<long long> progress{0};
+
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::thread reporter([&]() {
+        const char * unit = summary.bandwidthMode ? " GB/s" : " ops/s";
+        double scale = summary.bandwidthMode ? 1e9 : 1;
+
+        long long lastProgress = 0;
+        auto lastReport = startTime;
+
+        while (!deadline.expired())
+        {
+            deadline.waitUntil(lastReport + std::chrono::seconds(reportSeconds));
+
+            auto now = std::chrono::steady_clock::now();
+            long long currentProgress = progress.load(std::memory_order_relaxed);
+
+            std::chrono::duration<double> interval = now - lastReport;
+            std::chrono::duration<double> elapsed = now - startTime;
+
+            if (output)
+            {
+                std::ios::fmtflags flags = output->flags();
+                std::streamsize precision = output->precision();
+
+                *output << "[" << std::fixed << std::setprecision(1) << elapsed.count() << " s] "
+                    << "alvo: " << std::setprecision(2) << summary.target / scale << unit
+                    << ", obtido: " << (currentProgress - lastProgress) / interval.count() / scale << unit << std::endl;
+
+                output->flags(flags);
+                output->precision(precision);
+            }
+
+            lastProgress = currentProgress;
+            lastReport = now;
+        }
+    });
+
+    runParallel(threadCount, [&](int index) {
+        Range range = partitionRange(buffer.size(), threadCount, index, sizeof(uint64_t));
+
+        if (summary.bandwidthMode)
+        {
+            pressureBandwidthThread(buffer.data(), range, deadline, targetPerThread, progress);
+        } else {
+            pressureRandomThread(buffer.data(), range, streamSeed(seed, index), deadline, targetPerThread, progress);
+        }
+    }, placement);
+
+    reporter.join();
+
+    std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - startTime;
+    summary.achieved = progress.load() / totalTime.count();
+
+    return summary;
+}
+
+} // namespace memstress
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+#include "memstress/buffer.hpp"
+#include "memstress/parallel.hpp"
+
+namespace memstress
+{
+
+// Resultado do modo pressao, em bytes/s no modo banda ou operacoes/s no modo aleatorio
+struct PressureSummary
+{
+    bool bandwidthMode = false;
+    double target = 0;
+    double achieved = 0;
+};
+
+// Modo pressao (vizinho barulhento): mantem o buffer residente e gera uma banda (targetGbps) ou taxa de
+// operacoes aleatorias (targetOps) alvo ate o prazo, cada thread em sua propria faixa do buffer e com seu
+// proprio token bucket, presa na CPU do seu indice em placement (vazio sem afinidade). Seed 0 sorteia as
+// posicoes aleatorias, outro valor as repete a cada execucao. Se output nao for nulo, o alvo e o obtido
+// sao escritos a cada intervalo.
+PressureSummary runPressure(Buffer& buffer, int threadCount, const std::vector<int>& placement, const RunDeadline& deadline,
+    double targetGbps, double targetOps, uint64_t seed, int reportSeconds, std::ostream * output);
+
+} // namespace memstress
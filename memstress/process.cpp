@@ -0,0 +1,127 @@
+#include "memstress/process.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+    #include <csignal>
+    #include <sys/mman.h>
+    #include <sys/prctl.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+namespace memstress
+{
+
+SharedMemory::SharedMemory(size_t size)
+    : memorySize(size)
+{
+    #ifdef __linux__
+        void * mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if (mapped == MAP_FAILED)
+        {
+            failure = std::strerror(errno);
+            return;
+        }
+
+        memory = mapped;
+    #else
+        failure = "memória compartilhada entre processos disponível apenas no Linux";
+    #endif
+}
+
+SharedMemory::~SharedMemory()
+{
+    #ifdef __linux__
+        if (memory) munmap(memory, memorySize);
+    #endif
+}
+
+int forkWorker(const std::function<int()>& work, std::string& error)
+{
+    #ifdef __linux__
+        pid_t parent = getpid();
+        pid_t pid = fork();
+
+        if (pid < 0)
+        {
+            error = std::strerror(errno);
+            return -1;
+        }
+
+        if (pid > 0) return pid;
+
+        // Um filho orfao seguiria estressando a memoria sem ninguem para ler o resultado
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if (getppid() != parent) _exit(1);
+
+        _exit(work());
+    #else
+        (void) work;
+        error = "modo multiprocesso disponível apenas no Linux";
+        return -1;
+    #endif
+}
+
+WorkerStatus pollWorker(int pid, bool wait)
+{
+    WorkerStatus status;
+
+    #ifdef __linux__
+        int waitStatus = 0;
+        pid_t result;
+
+        do
+        {
+            result = waitpid(pid, &waitStatus, wait ? 0 : WNOHANG);
+        } while (result < 0 && errno == EINTR);
+
+        if (result == 0) return status;
+
+        status.running = false;
+
+        if (result < 0)
+        {
+            status.exitCode = -1;
+        }
+        else if (WIFSIGNALED(waitStatus))
+        {
+            status.signal = WTERMSIG(waitStatus);
+        } else {
+            status.exitCode = WEXITSTATUS(waitStatus);
+        }
+    #else
+        (void) pid;
+        (void) wait;
+        status.running = false;
+        status.exitCode = -1;
+    #endif
+
+    return status;
+}
+
+void killWorker(int pid)
+{
+    #ifdef __linux__
+        kill(pid, SIGKILL);
+    #else
+        (void) pid;
+    #endif
+}
+
+std::string describeWorkerStatus(const WorkerStatus& status)
+{
+    if (status.running) return "em execução";
+
+    #ifdef __linux__
+        if (status.signal != 0) return "terminou pelo sinal " + std::to_string(status.signal) + " (" + strsignal(status.signal) + ")";
+    #endif
+
+    if (status.exitCode == 0) return "concluído";
+
+    return "saiu com código " + std::to_string(status.exitCode);
+}
+
+} // namespace memstress
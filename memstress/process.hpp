@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace memstress
+{
+
+// Memoria anonima compartilhada com os processos filhos criados depois dela, zerada pelo kernel
+class SharedMemory
+{
+public:
+    explicit SharedMemory(size_t size);
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    void * data() const { return memory; }
+    size_t size() const { return memorySize; }
+
+    // Vazio se a memoria foi mapeada
+    const std::string& error() const { return failure; }
+
+private:
+    void * memory = nullptr;
+    size_t memorySize;
+    std::string failure;
+};
+
+// Cria um processo filho que roda work e sai com o codigo retornado, sem destrutores estaticos nem buffers
+// de saida herdados do pai. O filho morre junto se o pai morrer. Retorna o pid, ou -1 com o motivo em error.
+int forkWorker(const std::function<int()>& work, std::string& error);
+
+// Situacao de um processo filho
+struct WorkerStatus
+{
+    bool running = true;
+    int exitCode = 0;
+
+    // Sinal que terminou o processo, 0 se ele saiu pelo codigo
+    int signal = 0;
+};
+
+// Confere se o filho terminou, esperando por ele se wait. Depois de informar o fim o pid deixa de existir.
+WorkerStatus pollWorker(int pid, bool wait);
+
+// Mata o filho (SIGKILL), usado quando o pai desiste da execucao
+void killWorker(int pid);
+
+// "em execução", "saiu com código 1" ou "terminou pelo sinal 7 (Bus error)"
+std::string describeWorkerStatus(const WorkerStatus& status);
+
+} // namespace memstress
@@ -0,0 +1,84 @@
+#include "memstress/quarantine.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include "memstress/system.hpp"
+
+#ifdef __linux__
+    #include <sys/mman.h>
+
+    // Definidos aqui para compilar com cabecalhos sem CONFIG_MEMORY_FAILURE
+    #ifndef MADV_HWPOISON
+        #define MADV_HWPOISON 100
+    #endif
+
+    #ifndef MADV_SOFT_OFFLINE
+        #define MADV_SOFT_OFFLINE 101
+    #endif
+#endif
+
+namespace memstress
+{
+
+void PageQuarantine::configure(QuarantineMode mode, Range range, long long pageSize)
+{
+    quarantineMode = mode;
+    this->pageSize = pageSize;
+    firstPage = range.startIndex / pageSize;
+    pageCount = range.finalIndex > range.startIndex ? (range.finalIndex - 1) / pageSize - firstPage + 1 : 0;
+    isolatedCount = 0;
+    isolated.clear();
+}
+
+void PageQuarantine::restore(long long position)
+{
+    if (enabled()) exclude(position);
+}
+
+void PageQuarantine::exclude(long long position)
+{
+    if (pageCount == 0 || contains(position)) return;
+
+    if (isolated.empty()) isolated.assign(pageCount, false);
+
+    isolated[position / pageSize - firstPage] = true;
+    isolatedCount++;
+}
+
+bool PageQuarantine::isolate(volatile char * buffer, long long position, BadPage& page)
+{
+    if (!enabled() || contains(position)) return false;
+
+    if (isolated.empty()) isolated.assign(pageCount, false);
+
+    isolated[position / pageSize - firstPage] = true;
+    isolatedCount++;
+
+    volatile char * pageStart = buffer + position / pageSize * pageSize;
+
+    page.offset = position / pageSize * pageSize;
+    page.virtualAddress = reinterpret_cast<uintptr_t>(pageStart);
+
+    // O endereco fisico eh lido antes da acao, depois do soft-offline a pagina ja esta em outro frame
+    page.physicalAddress = physicalAddressOf(pageStart);
+    page.action = "isolada";
+
+    #ifdef __linux__
+        if (quarantineMode == QuarantineMode::SoftOffline || quarantineMode == QuarantineMode::Poison)
+        {
+            const char * name = quarantineMode == QuarantineMode::SoftOffline ? "soft-offline" : "hwpoison";
+            int advice = quarantineMode == QuarantineMode::SoftOffline ? MADV_SOFT_OFFLINE : MADV_HWPOISON;
+
+            if (madvise(const_cast<char *>(pageStart), pageSize, advice) == 0)
+            {
+                page.action += std::string(", ") + name;
+            } else {
+                page.action += std::string(", ") + name + " falhou: " + std::strerror(errno);
+            }
+        }
+    #endif
+
+    return true;
+}
+
+} // namespace memstress
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "memstress/parallel.hpp"
+
+namespace memstress
+{
+
+// O que fazer com a pagina onde uma falha foi detectada
+enum class QuarantineMode
+{
+    None,         // continua sorteando posicoes da pagina
+    Skip,         // exclui a pagina das proximas posicoes sorteadas
+    SoftOffline,  // exclui e pede ao kernel para aposentar o frame (MADV_SOFT_OFFLINE, exige CAP_SYS_ADMIN)
+    Poison        // exclui e marca o frame como defeituoso (MADV_HWPOISON, exige CAP_SYS_ADMIN)
+};
+
+// Pagina isolada durante o estresse
+struct BadPage
+{
+    int thread = 0;
+    long long offset = 0;
+    uintptr_t virtualAddress = 0;
+    unsigned long long physicalAddress = 0;
+    double seconds = 0;
+
+    // Resultado da acao no kernel, ex. "soft-offline" ou "soft-offline falhou: Operation not permitted"
+    std::string action;
+
+    // Pagina que gerou SIGBUS no acesso (envenenada pelo kernel), e nao uma falha da conferencia
+    bool sigbus = false;
+};
+
+// Paginas isoladas da faixa de uma thread. So a thread dona consulta e altera, sem sincronizacao.
+class PageQuarantine
+{
+public:
+    void configure(QuarantineMode mode, Range range, long long pageSize);
+
+    bool enabled() const { return quarantineMode != QuarantineMode::None; }
+
+    bool contains(long long position) const
+    {
+        return !isolated.empty() && isolated[position / pageSize - firstPage];
+    }
+
+    // Todas as paginas da faixa foram isoladas e a thread nao tem mais onde trabalhar
+    bool exhausted() const { return isolatedCount > 0 && isolatedCount == pageCount; }
+
+    // Isola a pagina da posicao e preenche o registro, retorna false se ja estava isolada
+    bool isolate(volatile char * buffer, long long position, BadPage& page);
+
+    // Marca como isolada uma pagina de uma execucao anterior, sem repetir a acao no kernel
+    void restore(long long position);
+
+    // Tira a pagina do sorteio em qualquer modo, mesmo sem quarentena: uma pagina envenenada nao pode ser
+    // acessada de novo
+    void exclude(long long position);
+
+private:
+    QuarantineMode quarantineMode = QuarantineMode::None;
+    long long pageSize = 4096;
+    long long firstPage = 0;
+    long long pageCount = 0;
+    long long isolatedCount = 0;
+
+    // Criado so na primeira falha, sem falhas a consulta eh um teste de vetor vazio
+    std::vector<bool> isolated;
+};
+
+} // namespace memstress
@@ -0,0 +1,185 @@
+#include "memstress/ramp.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <random>
+#include "memstress/cpu.hpp"
+#include "memstress/format.hpp"
+#include "memstress/kernels.hpp"
+#include "memstress/parallel.hpp"
+
+namespace memstress
+{
+
+namespace
+{
+
+// Duracao de cada medicao do modo rampa
+const std::chrono::milliseconds rampMeasureTime(200);
+
+// Kernel sequencial do modo rampa: le e inverte a faixa ate o prazo, retorna os bytes movidos
+long long rampStreamRange(volatile char * buffer, long long startIndex, long long finalIndex, std::chrono::time_point<std::chrono::steady_clock> deadline)
+{
+    long long passes = 0;
+
+    do
+    {
+        invertBlock(const_cast<char *>(buffer), startIndex, finalIndex);
+        passes++;
+    } while (deadline > std::chrono::steady_clock::now());
+
+    // Cada passada le e escreve a faixa inteira
+    return passes * (finalIndex - startIndex) * 2;
+}
+
+// Kernel aleatorio do modo rampa: inverte posicoes aleatorias da faixa ate o prazo, retorna as operacoes
+long long rampRandomRange(volatile char * buffer, long long startIndex, long long finalIndex, std::chrono::time_point<std::chrono::steady_clock> deadline)
+{
+    std::random_device randomDevice;
+    AddressGenerator memPositionGenerator(startIndex, finalIndex, randomDevice());
+
+    long long count = 0;
+
+    do
+    {
+        // Confere o relogio a cada bloco para nao medir o proprio steady_clock
+        for (int i = 0; i < 4096; i++)
+        {
+            long long memoryPosition = memPositionGenerator.next();
+            buffer[memoryPosition] = ~buffer[memoryPosition];
+        }
+
+        count += 4096;
+    } while (deadline > std::chrono::steady_clock::now());
+
+    return count;
+}
+
+// Divide o conjunto de trabalho entre as threads e retorna a soma do resultado de cada uma por segundo.
+// O tempo eh o medido: uma passada do kernel sequencial sobre um conjunto grande passa do prazo.
+double runRampKernel(long long (*kernel)(volatile char *, long long, long long, std::chrono::time_point<std::chrono::steady_clock>),
+    volatile char * buffer, long long workingSet, int threadCount, const std::vector<int>& placement)
+{
+    // Tamanho da linha de cache, usado como alinhamento das faixas e passo do pointer chasing
+    const long long rampSlotSize = cpuFeatures().cacheLineSize;
+
+    // Conjuntos pequenos demais para dividir ficam com uma thread so
+    if ((workingSet / threadCount) / rampSlotSize == 0) threadCount = 1;
+
+    std::vector<long long> results(threadCount, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + rampMeasureTime;
+
+    runParallel(threadCount, [&](int index) {
+        Range range = partitionRange(workingSet, threadCount, index, rampSlotSize);
+        results[index] = kernel(buffer, range.startIndex, range.finalIndex, deadline);
+    }, placement);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    long long total = 0;
+
+    for (long long result : results) total += result;
+
+    return total / elapsed.count();
+}
+
+// Latencia media de acesso (ns) por pointer chasing em um ciclo aleatorio de linhas de cache.
+// O ciclo eh montado no proprio buffer (algoritmo de Sattolo) para cada acesso depender do anterior.
+double rampLatency(volatile char * buffer, long long workingSet)
+{
+    const long long rampSlotSize = cpuFeatures().cacheLineSize;
+    long long slotCount = workingSet / rampSlotSize;
+    const long long wordsPerSlot = rampSlotSize / sizeof(uint64_t);
+    volatile uint64_t * words = reinterpret_cast<volatile uint64_t *>(buffer);
+
+    if (slotCount < 2) return 0;
+
+    for (long long i = 0; i < slotCount; i++)
+    {
+        words[i * wordsPerSlot] = i;
+    }
+
+    std::random_device randomDevice;
+    std::mt19937_64 generator(randomDevice());
+
+    for (long long i = slotCount - 1; i > 0; i--)
+    {
+        long long j = std::uniform_int_distribution<long long>(0, i - 1)(generator);
+        uint64_t temp = words[i * wordsPerSlot];
+        words[i * wordsPerSlot] = words[j * wordsPerSlot];
+        words[j * wordsPerSlot] = temp;
+    }
+
+    uint64_t slot = 0;
+    long long accesses = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + rampMeasureTime;
+
+    do
+    {
+        for (int i = 0; i < 4096; i++)
+        {
+            slot = words[slot * wordsPerSlot];
+        }
+
+        accesses += 4096;
+    } while (deadline > std::chrono::steady_clock::now());
+
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+    return elapsed.count() / accesses;
+}
+
+} // namespace
+
+std::vector<RampStep> runRamp(Buffer& buffer, int threadCount, const std::vector<int>& placement, std::ostream * output)
+{
+    std::vector<RampStep> steps;
+
+    if (output)
+    {
+        // Cabecalho escrito direto, setw conta os acentos em bytes e desalinharia as colunas
+        *output << "Tamanho       Stream (GB/s)   Latência (ns)   Aleatório (Mops/s)" << std::endl;
+    }
+
+    long long workingSet = 32 * 1024;
+
+    while (true)
+    {
+        if (workingSet > buffer.size()) workingSet = buffer.size();
+
+        RampStep step;
+        step.workingSet = workingSet;
+        step.streamGbps = runRampKernel(rampStreamRange, buffer.data(), workingSet, threadCount, placement) / 1e9;
+        step.randomMops = runRampKernel(rampRandomRange, buffer.data(), workingSet, threadCount, placement) / 1e6;
+        step.latencyNs = rampLatency(buffer.data(), workingSet);
+
+        steps.push_back(step);
+
+        if (output)
+        {
+            std::ios::fmtflags flags = output->flags();
+            std::streamsize precision = output->precision();
+
+            *output << std::left << std::fixed << std::setprecision(2)
+                << std::setw(14) << formatSize(workingSet)
+                << std::setw(16) << step.streamGbps
+                << std::setw(16) << step.latencyNs
+                << step.randomMops << std::endl;
+
+            output->flags(flags);
+            output->precision(precision);
+        }
+
+        if (workingSet == buffer.size()) break;
+
+        workingSet *= 2;
+    }
+
+    return steps;
+}
+
+} // namespace memstress
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ostream>
+#include <vector>
+#include "memstress/buffer.hpp"
+
+namespace memstress
+{
+
+// Medicoes de um passo do modo rampa
+struct RampStep
+{
+    long long workingSet;
+    double streamGbps;       // banda do kernel sequencial
+    double latencyNs;        // latencia media do pointer chasing
+    double randomMops;       // milhoes de operacoes aleatorias por segundo
+};
+
+// Modo rampa: aumenta o conjunto de trabalho de 32 KiB ate o buffer inteiro, dobrando a cada passo,
+// e mede banda, latencia e operacoes aleatorias para achar as transicoes de cache/DRAM/swap.
+// As threads ficam nas CPUs de placement (vazio sem afinidade). Se output nao for nulo, cada passo eh
+// escrito na tabela assim que medido.
+std::vector<RampStep> runRamp(Buffer& buffer, int threadCount, const std::vector<int>& placement, std::ostream * output);
+
+} // namespace memstress
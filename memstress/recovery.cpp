@@ -0,0 +1,115 @@
+#include "memstress/recovery.hpp"
+
+#include <mutex>
+
+#ifdef __linux__
+    #include <csignal>
+
+    // Codigos de erro de memoria do SIGBUS, ausentes em cabecalhos antigos
+    #ifndef BUS_MCEERR_AR
+        #define BUS_MCEERR_AR 4
+    #endif
+
+    #ifndef BUS_MCEERR_AO
+        #define BUS_MCEERR_AO 5
+    #endif
+#endif
+
+namespace memstress
+{
+
+#ifdef __linux__
+
+namespace
+{
+
+// Ponto armado da thread, lido pelo tratador que roda na propria thread que acessou a pagina
+thread_local RecoveryPoint * activePoint = nullptr;
+
+// Tratador que estava instalado antes do nosso (o do programa hospedeiro, de um sanitizer ou o padrao)
+struct sigaction previousSigbus = {};
+
+// Repassa o sinal ao tratador anterior. Sem funcao instalada (padrao ou ignorado) ele volta a valer e a
+// instrucao repetida recebe o tratamento que teria sem o nosso.
+void chainSigbus(int signal, siginfo_t * info, void * context)
+{
+    if (previousSigbus.sa_flags & SA_SIGINFO)
+    {
+        previousSigbus.sa_sigaction(signal, info, context);
+    } else if (previousSigbus.sa_handler != SIG_DFL && previousSigbus.sa_handler != SIG_IGN) {
+        previousSigbus.sa_handler(signal);
+    } else {
+        sigaction(signal, &previousSigbus, nullptr);
+    }
+}
+
+void handleSigbus(int signal, siginfo_t * info, void * context)
+{
+    // O aviso antecipado chega em qualquer thread, no meio de qualquer coisa. A pagina ja saiu do processo
+    // e o acesso seguinte a ela gera o BUS_MCEERR_AR, tratado na thread que a acessou.
+    if (info->si_code == BUS_MCEERR_AO) return;
+
+    RecoveryPoint * point = activePoint;
+    uintptr_t address = reinterpret_cast<uintptr_t>(info->si_addr);
+
+    if (!point || address < point->rangeStart || address >= point->rangeEnd)
+    {
+        chainSigbus(signal, info, context);
+        return;
+    }
+
+    activePoint = nullptr;
+    point->address = address;
+    point->code = info->si_code;
+
+    siglongjmp(point->jump, 1);
+}
+
+} // namespace
+
+void armRecovery(RecoveryPoint& point, const volatile void * start, const volatile void * end)
+{
+    point.rangeStart = reinterpret_cast<uintptr_t>(start);
+    point.rangeEnd = reinterpret_cast<uintptr_t>(end);
+    activePoint = &point;
+}
+
+void disarmRecovery()
+{
+    activePoint = nullptr;
+}
+
+#endif
+
+void installSigbusHandler()
+{
+    #ifdef __linux__
+        static std::once_flag installed;
+
+        std::call_once(installed, []() {
+            struct sigaction action = {};
+            action.sa_sigaction = handleSigbus;
+            action.sa_flags = SA_SIGINFO;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGBUS, &action, &previousSigbus);
+        });
+    #endif
+}
+
+std::string describeSigbusCode(int code)
+{
+    #ifdef __linux__
+        switch (code)
+        {
+            case BUS_MCEERR_AR: return "BUS_MCEERR_AR (erro não corrigido consumido)";
+            case BUS_MCEERR_AO: return "BUS_MCEERR_AO (erro não corrigido detectado pela varredura)";
+            case BUS_ADRERR: return "BUS_ADRERR (endereço sem memória por trás)";
+            case BUS_OBJERR: return "BUS_OBJERR (erro de hardware no objeto)";
+            case BUS_ADRALN: return "BUS_ADRALN (alinhamento)";
+        }
+    #endif
+
+    return "código " + std::to_string(code);
+}
+
+} // namespace memstress
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#ifdef __linux__
+    #include <csetjmp>
+#endif
+
+namespace memstress
+{
+
+#ifdef __linux__
+    // Ponto de retomada de uma thread de estresse. Um SIGBUS com endereco na faixa armada (pagina envenenada
+    // por um erro nao corrigido, o kernel tira o frame do processo) volta ao sigsetjmp do ponto em vez de
+    // derrubar o processo, com o endereco e o si_code do sinal.
+    struct RecoveryPoint
+    {
+        sigjmp_buf jump;
+        uintptr_t rangeStart = 0;
+        uintptr_t rangeEnd = 0;
+
+        volatile uintptr_t address = 0;
+        volatile int code = 0;
+    };
+
+    // Arma o ponto na thread atual para a faixa [start, end). O siglongjmp passa por cima dos objetos do
+    // trecho armado, que nao podem ter destrutores pendentes.
+    void armRecovery(RecoveryPoint& point, const volatile void * start, const volatile void * end);
+    void disarmRecovery();
+#endif
+
+// Instala o tratador de SIGBUS do processo, uma vez so. Sem ponto armado na thread, ou com o endereco fora
+// da faixa dele, o SIGBUS vai para o tratador que estava instalado antes (o padrao derruba o processo).
+void installSigbusHandler();
+
+// Nome do si_code do SIGBUS, ex. "BUS_MCEERR_AR (erro não corrigido consumido)"
+std::string describeSigbusCode(int code);
+
+} // namespace memstress
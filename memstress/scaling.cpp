@@ -0,0 +1,327 @@
+#include "memstress/scaling.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <thread>
+#include "memstress/cpu.hpp"
+#include "memstress/kernels.hpp"
+#include "memstress/parallel.hpp"
+
+namespace memstress
+{
+
+namespace
+{
+
+// Duracao de cada medicao da varredura
+const std::chrono::milliseconds scalingMeasureTime(300);
+
+// Pedaco da faixa de cada thread entre as conferencias do prazo
+const long long scalingChunkSize = 16 * 1024 * 1024;
+
+// Fracao da maior banda da curva que conta como saturada
+const double saturationFraction = 0.95;
+
+using ScalingClock = std::chrono::steady_clock;
+
+// Evita que o compilador descarte a conferencia, que so le
+volatile long long verifySink = 0;
+
+// Roda o kernel de blocos na faixa ate o prazo, retorna os bytes lidos e escritos. A faixa eh percorrida
+// em pedacos com o prazo conferido a cada um, uma passada inteira em um buffer grande levaria segundos.
+long long runBlockKernel(const std::string& kernel, char * buffer, Range range, bool streaming, ScalingClock::time_point deadline)
+{
+    long long position = range.startIndex;
+    long long bytes = 0;
+    long long mismatches = 0;
+
+    if (range.finalIndex <= range.startIndex) return 0;
+
+    do
+    {
+        long long chunkEnd = std::min(position + scalingChunkSize, range.finalIndex);
+        long long length = chunkEnd - position;
+        long long half = length / 2;
+
+        if (kernel == "fill")
+        {
+            if (streaming)
+            {
+                fillPatternStreaming(buffer, position, chunkEnd);
+            } else {
+                fillPattern(buffer, position, chunkEnd);
+            }
+        }
+        else if (kernel == "verify")
+        {
+            mismatches += countPatternMismatches(buffer, position, chunkEnd);
+        }
+        else if (kernel == "invert")
+        {
+            invertBlock(buffer, position, chunkEnd);
+        } else {
+            swapBlocks(buffer + position, buffer + position + half, half);
+        }
+
+        // O preenchimento so escreve e a conferencia so le; a inversao e a troca leem e escrevem cada byte
+        if (kernel == "fill" || kernel == "verify")
+        {
+            bytes += length;
+        }
+        else if (kernel == "swap")
+        {
+            bytes += half * 4;
+        } else {
+            bytes += length * 2;
+        }
+
+        position = chunkEnd == range.finalIndex ? range.startIndex : chunkEnd;
+    } while (deadline > ScalingClock::now());
+
+    verifySink = verifySink + mismatches;
+
+    return bytes;
+}
+
+// Inverte posicoes aleatorias da faixa ate o prazo, retorna as operacoes
+long long runRandomKernel(volatile char * buffer, Range range, uint64_t seed, ScalingClock::time_point deadline)
+{
+    if (range.finalIndex <= range.startIndex) return 0;
+
+    AddressGenerator memPositionGenerator(range.startIndex, range.finalIndex, seed);
+    long long count = 0;
+
+    do
+    {
+        // Confere o relogio a cada bloco para nao medir o proprio steady_clock
+        for (int i = 0; i < 4096; i++)
+        {
+            long long memoryPosition = memPositionGenerator.next();
+            buffer[memoryPosition] = ~buffer[memoryPosition];
+        }
+
+        count += 4096;
+    } while (deadline > ScalingClock::now());
+
+    return count;
+}
+
+// Mede um passo: cada kernel com as threads presas nas primeiras CPUs da curva, dividindo o buffer inteiro
+ScalingStep measureStep(Buffer& buffer, const std::vector<int>& cpus, int threadCount, const std::vector<std::string>& kernels,
+    uint64_t seed, double& bytes)
+{
+    ScalingStep step;
+    step.threads = threadCount;
+
+    std::vector<int> placement = cpus.empty() ? std::vector<int>() : std::vector<int>(cpus.begin(), cpus.begin() + threadCount);
+
+    // Mesmo criterio do preenchimento do buffer: bem maior que a ultima cache usa escritas non-temporal
+    long long cacheSize = cpuFeatures().lastLevelCacheSize;
+    bool streaming = buffer.size() > 2 * (cacheSize > 0 ? cacheSize : 32LL * 1024 * 1024);
+    long long alignment = cpuFeatures().cacheLineSize;
+    std::vector<long long> results(threadCount, 0);
+
+    auto sumResults = [&]() {
+        long long total = 0;
+        for (long long result : results) total += result;
+        return total;
+    };
+
+    for (const std::string& kernel : kernels)
+    {
+        // A inversao e as inversoes aleatorias do passo anterior desfazem o padrao, e a conferencia de um
+        // pedaco com diferencas cai no caminho lento. O preenchimento fica fora da medicao.
+        if (kernel == "verify") buffer.fill(threadCount, placement);
+
+        auto start = ScalingClock::now();
+        auto deadline = start + scalingMeasureTime;
+
+        runParallel(threadCount, [&](int index) {
+            Range range = partitionRange(buffer.size(), threadCount, index, alignment);
+            results[index] = runBlockKernel(kernel, const_cast<char *>(buffer.data()), range, streaming, deadline);
+        }, placement);
+
+        // Dividido pelo tempo medido, o ultimo pedaco de cada thread passa um pouco do prazo
+        std::chrono::duration<double> elapsed = ScalingClock::now() - start;
+        long long total = sumResults();
+        bytes += total;
+        step.gbps.push_back(total / 1e9 / elapsed.count());
+    }
+
+    auto start = ScalingClock::now();
+    auto deadline = start + scalingMeasureTime;
+
+    runParallel(threadCount, [&](int index) {
+        Range range = partitionRange(buffer.size(), threadCount, index, alignment);
+        results[index] = runRandomKernel(buffer.data(), range, streamSeed(seed, index), deadline);
+    }, placement);
+
+    std::chrono::duration<double> elapsed = ScalingClock::now() - start;
+    long long operations = sumResults();
+    bytes += operations * 2.0;
+    step.randomMops = operations / 1e6 / elapsed.count();
+
+    return step;
+}
+
+// 1, 2, 4... ate a quantidade de CPUs, que entra no fim mesmo sem ser potencia de 2
+std::vector<int> sweepThreadCounts(int cpuCount)
+{
+    std::vector<int> counts;
+
+    for (int threads = 1; threads < cpuCount; threads *= 2) counts.push_back(threads);
+
+    counts.push_back(cpuCount);
+    return counts;
+}
+
+void printHeader(std::ostream& output, const ScalingCurve& curve, const std::vector<std::string>& kernels)
+{
+    if (curve.node < 0)
+    {
+        output << "\nMáquina inteira (" << curve.cpuCount << " CPUs";
+    } else {
+        output << "\nNó " << curve.node << " (" << curve.cpuCount << " CPUs";
+    }
+
+    if (!curve.memoryError.empty()) output << ", memória não recolocada: " << curve.memoryError;
+
+    output << ")" << std::endl;
+
+    // Cabecalho escrito direto, setw conta os acentos em bytes e desalinharia as colunas
+    output << "Threads  ";
+    for (const std::string& kernel : kernels) output << std::left << std::setw(14) << (kernel + " (GB/s)");
+    output << "Aleatório (Mops/s)" << std::endl;
+}
+
+void printStep(std::ostream& output, const ScalingStep& step)
+{
+    std::ios::fmtflags flags = output.flags();
+    std::streamsize precision = output.precision();
+
+    output << std::left << std::fixed << std::setprecision(2) << std::setw(9) << step.threads;
+    for (double gbps : step.gbps) output << std::setw(14) << gbps;
+    output << step.randomMops << std::endl;
+
+    output.flags(flags);
+    output.precision(precision);
+}
+
+// Saturacao de cada kernel: o primeiro passo que chega perto do pico, dali em diante mais threads quase
+// nao rendem banda
+void findSaturation(ScalingCurve& curve, size_t kernelCount)
+{
+    for (size_t kernel = 0; kernel < kernelCount; kernel++)
+    {
+        double peak = 0;
+
+        for (const ScalingStep& step : curve.steps) peak = std::max(peak, step.gbps[kernel]);
+
+        int saturation = curve.steps.empty() ? 0 : curve.steps.back().threads;
+
+        for (const ScalingStep& step : curve.steps)
+        {
+            if (step.gbps[kernel] >= peak * saturationFraction)
+            {
+                saturation = step.threads;
+                break;
+            }
+        }
+
+        curve.peakGbps.push_back(peak);
+        curve.saturationThreads.push_back(saturation);
+    }
+}
+
+} // namespace
+
+const std::vector<std::string>& scalingKernelNames()
+{
+    static const std::vector<std::string> names{"fill", "verify", "invert", "swap"};
+    return names;
+}
+
+ScalingSummary runScalingSweep(Buffer& buffer, const CpuTopology& topology, const std::vector<std::string>& kernels,
+    uint64_t seed, std::ostream * output)
+{
+    ScalingSummary summary;
+    summary.kernels = kernels;
+
+    // Ordem scatter: cada passo soma nucleos novos, e os irmaos SMT so entram depois de todos os nucleos
+    std::vector<int> order = planPlacement(topology, PlacementPolicy::Scatter, static_cast<int>(topology.cpus.size()));
+
+    ScalingCurve machine;
+    machine.cpus = order;
+
+    // Sem topologia (fora do Linux) as threads ficam sem afinidade, so a quantidade varia
+    machine.cpuCount = order.empty() ? std::max(1, static_cast<int>(std::thread::hardware_concurrency())) : static_cast<int>(order.size());
+
+    if (topology.nodeCount > 1)
+    {
+        for (int node = 0; node < topology.nodeCount; node++)
+        {
+            ScalingCurve curve;
+            curve.node = node;
+
+            for (int cpu : order)
+            {
+                auto logical = std::find_if(topology.cpus.begin(), topology.cpus.end(), [&](const LogicalCpu& candidate) { return candidate.id == cpu; });
+                if (logical != topology.cpus.end() && logical->node == node) curve.cpus.push_back(cpu);
+            }
+
+            curve.cpuCount = static_cast<int>(curve.cpus.size());
+            if (curve.cpuCount > 0) summary.curves.push_back(curve);
+        }
+    } else {
+        machine.node = 0;
+    }
+
+    summary.curves.push_back(machine);
+
+    for (ScalingCurve& curve : summary.curves)
+    {
+        // As paginas ficaram onde o preenchimento sem afinidade as colocou. Preenchidas de novo pelas threads
+        // presas nas CPUs da curva, ficam no proprio no, ou espalhadas pelos nos na maquina inteira.
+        if (topology.nodeCount > 1) curve.memoryError = buffer.refill(curve.cpuCount, curve.cpus);
+
+        if (output) printHeader(*output, curve, kernels);
+
+        for (int threads : sweepThreadCounts(curve.cpuCount))
+        {
+            ScalingStep step = measureStep(buffer, curve.cpus, threads, kernels, seed, summary.bytes);
+            curve.steps.push_back(step);
+
+            if (output) printStep(*output, step);
+        }
+
+        findSaturation(curve, kernels.size());
+    }
+
+    if (!output) return summary;
+
+    *output << "\nSaturação (menor quantidade de threads com " << static_cast<int>(saturationFraction * 100) << "% da maior banda):" << std::endl;
+
+    std::ios::fmtflags flags = output->flags();
+    std::streamsize precision = output->precision();
+
+    for (const ScalingCurve& curve : summary.curves)
+    {
+        *output << (curve.node < 0 ? std::string("  Máquina inteira") : "  Nó " + std::to_string(curve.node)) << ":";
+
+        for (size_t kernel = 0; kernel < kernels.size(); kernel++)
+        {
+            *output << (kernel == 0 ? " " : ", ") << kernels[kernel] << " " << curve.saturationThreads[kernel] << " threads ("
+                << std::fixed << std::setprecision(2) << curve.peakGbps[kernel] << " GB/s)";
+        }
+
+        *output << std::endl;
+    }
+
+    output->flags(flags);
+    output->precision(precision);
+
+    return summary;
+}
+
+} // namespace memstress
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "memstress/buffer.hpp"
+#include "memstress/topology.hpp"
+
+namespace memstress
+{
+
+// Medicoes de um passo da varredura: a banda de cada kernel de blocos e as operacoes aleatorias
+struct ScalingStep
+{
+    int threads = 0;
+    std::vector<double> gbps;  // na ordem dos kernels pedidos
+    double randomMops = 0;     // milhoes de inversoes aleatorias por segundo
+};
+
+// Curva de um conjunto de CPUs, um no NUMA ou a maquina inteira
+struct ScalingCurve
+{
+    int node = -1;  // -1 para a maquina inteira
+
+    // CPUs na ordem em que as threads sao somadas; vazio sem topologia, com as threads sem afinidade
+    int cpuCount = 0;
+    std::vector<int> cpus;
+    std::vector<ScalingStep> steps;
+
+    // Com mais de um no o buffer eh recolocado antes de cada curva: na memoria do proprio no, ou espalhado
+    // pelos nos na maquina inteira. Vazio se foi recolocado, senao o motivo, e a curva mede as paginas
+    // onde estavam.
+    std::string memoryError;
+
+    // Por kernel: menor quantidade de threads que chega a 95% da maior banda da curva, e essa banda
+    std::vector<int> saturationThreads;
+    std::vector<double> peakGbps;
+};
+
+struct ScalingSummary
+{
+    std::vector<std::string> kernels;
+    std::vector<ScalingCurve> curves;
+
+    // Bytes lidos e escritos por todas as medicoes, para o EDAC
+    double bytes = 0;
+};
+
+// Kernels de blocos que a varredura sabe medir
+const std::vector<std::string>& scalingKernelNames();
+
+// Varredura de escalabilidade: roda cada kernel com 1, 2, 4... threads ate todas as CPUs do conjunto,
+// presas na ordem scatter (nucleos antes dos irmaos SMT), e mede a banda agregada e as operacoes
+// aleatorias de cada passo. Com mais de um no NUMA cada no tem a sua curva, medida na memoria do proprio
+// no (o buffer eh descartado e preenchido de novo pelas threads presas nele), alem da maquina inteira.
+// Se output nao for nulo, cada passo eh escrito assim que medido.
+ScalingSummary runScalingSweep(Buffer& buffer, const CpuTopology& topology, const std::vector<std::string>& kernels,
+    uint64_t seed, std::ostream * output);
+
+} // namespace memstress
@@ -0,0 +1,2090 @@
+#include "memstress/session.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include "memstress/cpu.hpp"
+#include "memstress/edac.hpp"
+#include "memstress/kernels.hpp"
+#include "memstress/metrics.hpp"
+#include "memstress/parallel.hpp"
+#include "memstress/process.hpp"
+#include "memstress/quarantine.hpp"
+#include "memstress/recovery.hpp"
+#include "memstress/stats.hpp"
+#include "memstress/system.hpp"
+#include "memstress/trace.hpp"
+
+namespace memstress
+{
+
+namespace
+{
+
+// Operacoes entre cada consulta ao relogio nas threads de estresse
+const int stressBatch = 1024;
+
+// Nome da fase principal de cada modo nos relatorios
+const char * phaseName(StressMode mode)
+{
+    switch (mode)
+    {
+        case StressMode::Ramp: return "rampa";
+        case StressMode::Pressure: return "pressão";
+        case StressMode::Interleave: return "interleave";
+        case StressMode::Churn: return "churn";
+        case StressMode::Replay: return "replay";
+        case StressMode::Scaling: return "varredura";
+        case StressMode::Mixed: return "mista";
+        default: return "estresse";
+    }
+}
+
+// Bytes lidos (incluindo a releitura de conferencia) e escritos por operacao
+const long long invertBytesRead = 2;
+const long long invertBytesWritten = 1;
+const long long swapBytesRead = 4;
+const long long swapBytesWritten = 2;
+
+// Falhas guardadas por thread, o contador de erros continua contando as demais
+const size_t maxFaultsPerThread = 32;
+
+// Blocos do anel de trace de cada thread, um por lote: duas palavras por operacao (a troca) e folga
+// para as falhas do lote. 256 blocos de ~17 KB dao folga para alguns intervalos de gravacao.
+const size_t traceFaultWords = 64;
+const size_t traceBlockWords = 2 + 2 * stressBatch + traceFaultWords;
+const size_t traceRingBlocks = 256;
+
+// Ponto de troca entre uma thread de estresse e o escritor do checkpoint. O escritor pede e a thread copia
+// o proprio estado entre dois lotes, assim o gerador e as falhas nunca sao lidos enquanto mudam.
+class CheckpointSlot
+{
+public:
+    void request()
+    {
+        requested.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    bool pending() const
+    {
+        return served.load(std::memory_order_relaxed) != requested.load(std::memory_order_relaxed);
+    }
+
+    // A ultima captura pedida foi feita, ou a thread terminou e deixou o estado final
+    bool ready() const
+    {
+        return finished.load(std::memory_order_acquire) || !pending();
+    }
+
+    void capture(ThreadCheckpoint state, bool last)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = std::move(state);
+        served.store(requested.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        if (last) finished.store(true, std::memory_order_release);
+    }
+
+    ThreadCheckpoint state()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return snapshot;
+    }
+
+private:
+    std::atomic<long long> requested{0};
+    std::atomic<long long> served{0};
+    std::atomic<bool> finished{false};
+
+    std::mutex mutex;
+    ThreadCheckpoint snapshot;
+};
+
+// Falhas de uma thread e as paginas que ela isolou. O endereco fisico eh lido na deteccao, enquanto a
+// pagina ainda esta no mesmo frame.
+struct FaultLog
+{
+    int thread = 0;
+    std::chrono::time_point<std::chrono::steady_clock> startTime;
+    ThreadStats * stats = nullptr;
+
+    std::vector<FaultRecord> records;
+    PageQuarantine quarantine;
+    std::vector<BadPage> badPages;
+
+    // Checkpoint da thread, nulo sem checkpoint, e o estado do gerador de uma execucao interrompida
+    CheckpointSlot * checkpoint = nullptr;
+    std::string generatorState;
+
+    // Posicao do gerador no inicio do lote atual, de onde a thread recomeca depois de um SIGBUS
+    uint64_t batchSequence = 0;
+    bool recovered = false;
+
+    // Anel do trace da thread, nulo sem trace, e o bloco do lote atual (nulo sem bloco livre)
+    TraceRing * trace = nullptr;
+    uint64_t * traceCursor = nullptr;
+
+    // Palavras da folga do bloco que as falhas do lote ainda podem usar. As operacoes do lote tem espaco
+    // garantido no bloco, entao as falhas nunca passam da folga, mesmo em um lote so de falhas.
+    size_t traceFaultBudget = 0;
+
+    void record(volatile char * buffer, long long memoryPosition, uint64_t sequence)
+    {
+        // A falha ocupa duas palavras, sem folga ela fica fora do trace e eh contada
+        if (traceCursor && traceFaultBudget >= 2)
+        {
+            *traceCursor++ = traceWord(TraceEventType::Fault, memoryPosition, 0);
+            *traceCursor++ = sequence;
+            traceFaultBudget -= 2;
+        }
+        else if (traceCursor)
+        {
+            trace->dropFault();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        BadPage page;
+
+        if (quarantine.isolate(buffer, memoryPosition, page))
+        {
+            page.thread = thread;
+            page.seconds = seconds;
+            badPages.push_back(page);
+
+            ThreadStats::add(stats->quarantinedPages, 1);
+        }
+
+        if (records.size() >= maxFaultsPerThread) return;
+
+        FaultRecord fault;
+        fault.thread = thread;
+        fault.offset = memoryPosition;
+        fault.virtualAddress = reinterpret_cast<uintptr_t>(buffer + memoryPosition);
+        fault.physicalAddress = physicalAddressOf(buffer + memoryPosition);
+        fault.seconds = seconds;
+        fault.sequence = sequence;
+
+        records.push_back(fault);
+    }
+
+    // Abre o bloco do lote no trace. O instante vai so no lote, o relogio em cada operacao pesaria no laco.
+    void beginTraceBatch()
+    {
+        if (!trace) return;
+
+        auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTime).count();
+
+        traceCursor = trace->beginBlock(nanos);
+        traceFaultBudget = traceFaultWords;
+    }
+
+    void endTraceBatch()
+    {
+        if (traceCursor) trace->endBlock(traceCursor);
+        traceCursor = nullptr;
+    }
+
+    // Operacoes no trace com o valor escrito em cada posicao
+    void traceInvert(long long memoryPosition, char written)
+    {
+        if (traceCursor) *traceCursor++ = traceWord(TraceEventType::Invert, memoryPosition, static_cast<uint8_t>(written));
+    }
+
+    void traceSwap(long long firstMemoryPosition, long long secondMemoryPosition, char firstWritten, char secondWritten)
+    {
+        if (!traceCursor) return;
+
+        *traceCursor++ = traceWord(TraceEventType::Swap, firstMemoryPosition, static_cast<uint8_t>(firstWritten));
+        *traceCursor++ = traceWord(TraceEventType::Swap, secondMemoryPosition, static_cast<uint8_t>(secondWritten));
+    }
+
+    // Sorteia uma posicao fora das paginas isoladas. Com a faixa toda isolada nao ha para onde fugir.
+    long long nextPosition(AddressGenerator& generator) const
+    {
+        long long memoryPosition = generator.next();
+
+        while (quarantine.contains(memoryPosition) && !quarantine.exhausted()) memoryPosition = generator.next();
+
+        return memoryPosition;
+    }
+
+    // Pagina envenenada: o kernel ja tirou o frame do processo e um novo acesso daria outro SIGBUS, entao
+    // ela sai do sorteio mesmo sem quarentena. Entra nas falhas, com a sequencia do lote interrompido, e
+    // nas paginas isoladas com o codigo do sinal.
+    void recordSigbus(volatile char * buffer, uintptr_t address, int code)
+    {
+        long long pageSize = getPageSize();
+        long long memoryPosition = static_cast<long long>(address - reinterpret_cast<uintptr_t>(buffer));
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+        quarantine.exclude(memoryPosition);
+        recovered = true;
+        endTraceBatch();
+
+        ThreadStats::add(stats->errors, 1);
+        ThreadStats::add(stats->quarantinedPages, 1);
+
+        BadPage page;
+        page.thread = thread;
+        page.offset = memoryPosition / pageSize * pageSize;
+        page.virtualAddress = reinterpret_cast<uintptr_t>(buffer + page.offset);
+        page.physicalAddress = physicalAddressOf(buffer + page.offset);
+        page.seconds = seconds;
+        page.action = "SIGBUS " + describeSigbusCode(code) + ", excluída do estresse";
+        page.sigbus = true;
+        badPages.push_back(page);
+
+        if (records.size() >= maxFaultsPerThread) return;
+
+        FaultRecord fault;
+        fault.thread = thread;
+        fault.offset = memoryPosition;
+        fault.virtualAddress = address;
+        fault.physicalAddress = page.physicalAddress;
+        fault.seconds = seconds;
+        fault.sequence = batchSequence;
+
+        records.push_back(fault);
+    }
+
+    // Continua a sequencia de posicoes da execucao interrompida, ou do lote que um SIGBUS interrompeu
+    void restoreGenerator(AddressGenerator& generator) const
+    {
+        if (recovered)
+        {
+            generator.jump(batchSequence);
+            return;
+        }
+
+        if (!generatorState.empty()) generator.restore(generatorState);
+    }
+
+    // Copia o estado para o checkpoint se o escritor pediu, ou sempre na saida da thread
+    void serveCheckpoint(const AddressGenerator * generator, bool last)
+    {
+        if (!checkpoint || (!last && !checkpoint->pending())) return;
+
+        ThreadCheckpoint state;
+        state.operations = stats->operations.load(std::memory_order_relaxed);
+        state.bytesRead = stats->bytesRead.load(std::memory_order_relaxed);
+        state.bytesWritten = stats->bytesWritten.load(std::memory_order_relaxed);
+        state.errors = stats->errors.load(std::memory_order_relaxed);
+        state.maxLatencyNanos = stats->maxLatencyNanos.load(std::memory_order_relaxed);
+        state.quarantinedPages = stats->quarantinedPages.load(std::memory_order_relaxed);
+        state.latencySumNanos = stats->latencySumNanos.load(std::memory_order_relaxed);
+
+        for (const std::atomic<long long>& bucket : stats->latencyBuckets) state.latencyBuckets.push_back(bucket.load(std::memory_order_relaxed));
+
+        if (generator) state.generatorState = generator->state();
+        state.faults = records;
+        state.badPages = badPages;
+
+        checkpoint->capture(std::move(state), last);
+    }
+};
+
+// Tempo de uma operacao em ns
+template <typename Operation>
+long long timeOperation(Operation operation, bool& ok)
+{
+    auto start = std::chrono::steady_clock::now();
+    ok = operation();
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Registra um lote no bloco da thread
+void recordBatch(ThreadStats& stats, long long errors, long long bytesRead, long long bytesWritten, long long latencyNanos)
+{
+    ThreadStats::add(stats.operations, stressBatch);
+    ThreadStats::add(stats.bytesRead, stressBatch * bytesRead);
+    ThreadStats::add(stats.bytesWritten, stressBatch * bytesWritten);
+    if (errors > 0) ThreadStats::add(stats.errors, errors);
+    stats.recordLatency(latencyNanos);
+}
+
+// Thread que inverte o valor binario de posicoes aleatorias da sua faixa.
+// A primeira operacao de cada lote eh cronometrada, uma amostra da latencia sem consultar o relogio em todas.
+void invertBinaryValueThread(volatile char * buffer, Range range, uint64_t seed, const RunDeadline& deadline, ThreadStats& stats, FaultLog& faults)
+{
+    AddressGenerator memPositionGenerator(range.startIndex, range.finalIndex, seed);
+    faults.restoreGenerator(memPositionGenerator);
+
+    auto invertRandomPosition = [&]() {
+        uint64_t sequence = memPositionGenerator.position();
+        long long memoryPosition = faults.nextPosition(memPositionGenerator);
+        char written = 0;
+        bool ok = invertPosition(buffer, memoryPosition, written);
+
+        faults.traceInvert(memoryPosition, written);
+        if (!ok) faults.record(buffer, memoryPosition, sequence);
+
+        return ok;
+    };
+
+    while (!deadline.expired() && !faults.quarantine.exhausted())
+    {
+        faults.batchSequence = memPositionGenerator.position();
+        faults.beginTraceBatch();
+
+        bool ok = true;
+        long long latencyNanos = timeOperation(invertRandomPosition, ok);
+        long long errors = !ok;
+
+        for (int i = 1; i < stressBatch; i++)
+        {
+            errors += !invertRandomPosition();
+        }
+
+        recordBatch(stats, errors, invertBytesRead, invertBytesWritten, latencyNanos);
+        faults.endTraceBatch();
+        faults.serveCheckpoint(&memPositionGenerator, false);
+    }
+
+    faults.serveCheckpoint(&memPositionGenerator, true);
+}
+
+// Thread que faz o swap do valor de duas posicoes aleatorias da sua faixa
+void swapValuesThread(volatile char * buffer, Range range, uint64_t seed, const RunDeadline& deadline, ThreadStats& stats, FaultLog& faults)
+{
+    AddressGenerator memPositionGenerator(range.startIndex, range.finalIndex, seed);
+    faults.restoreGenerator(memPositionGenerator);
+
+    // A conferencia nao diz qual das duas posicoes falhou, entao as duas vao para o relatorio
+    auto swapRandomPositions = [&]() {
+        uint64_t sequence = memPositionGenerator.position();
+        long long firstMemoryPosition = faults.nextPosition(memPositionGenerator);
+        long long secondMemoryPosition = faults.nextPosition(memPositionGenerator);
+        char firstWritten = 0;
+        char secondWritten = 0;
+        bool ok = swapPositions(buffer, firstMemoryPosition, secondMemoryPosition, firstWritten, secondWritten);
+
+        faults.traceSwap(firstMemoryPosition, secondMemoryPosition, firstWritten, secondWritten);
+
+        if (!ok)
+        {
+            faults.record(buffer, firstMemoryPosition, sequence);
+            faults.record(buffer, secondMemoryPosition, sequence);
+        }
+
+        return ok;
+    };
+
+    while (!deadline.expired() && !faults.quarantine.exhausted())
+    {
+        faults.batchSequence = memPositionGenerator.position();
+        faults.beginTraceBatch();
+
+        bool ok = true;
+        long long latencyNanos = timeOperation(swapRandomPositions, ok);
+        long long errors = !ok;
+
+        for (int i = 1; i < stressBatch; i++)
+        {
+            errors += !swapRandomPositions();
+        }
+
+        recordBatch(stats, errors, swapBytesRead, swapBytesWritten, latencyNanos);
+        faults.endTraceBatch();
+        faults.serveCheckpoint(&memPositionGenerator, false);
+    }
+
+    faults.serveCheckpoint(&memPositionGenerator, true);
+}
+
+// Reexecuta a sequencia de uma thread do estresse a partir de uma posicao do gerador. Com a mesma semente
+// e a mesma faixa as posicoes sao as mesmas do estresse original, e a conferencia de cada operacao nao
+// depende do que a precedeu, entao comecar no meio da sequencia em um buffer recem-preenchido eh valido.
+// Paginas isoladas pela quarentena no original mudam a sequencia dali em diante (as posicoes nelas foram
+// sorteadas de novo), por isso o replay deve partir da sequencia da primeira falha.
+void replayThread(volatile char * buffer, Range range, uint64_t seed, bool swap, uint64_t from, long long count,
+    const RunDeadline& deadline, ThreadStats& stats, FaultLog& faults, std::atomic<long long>& passes)
+{
+    AddressGenerator memPositionGenerator(range.startIndex, range.finalIndex, seed);
+    memPositionGenerator.jump(from);
+
+    long long windowOperations = 0;
+
+    auto replayOperation = [&]() {
+        // Fim da janela: volta ao inicio dela para repetir exatamente as mesmas operacoes
+        if (count > 0 && windowOperations == count)
+        {
+            memPositionGenerator.jump(from);
+            windowOperations = 0;
+            passes.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        windowOperations++;
+
+        uint64_t sequence = memPositionGenerator.position();
+        long long firstMemoryPosition = memPositionGenerator.next();
+
+        if (!swap)
+        {
+            char written = 0;
+            bool ok = invertPosition(buffer, firstMemoryPosition, written);
+            faults.traceInvert(firstMemoryPosition, written);
+            if (!ok) faults.record(buffer, firstMemoryPosition, sequence);
+            return ok;
+        }
+
+        long long secondMemoryPosition = memPositionGenerator.next();
+        char firstWritten = 0;
+        char secondWritten = 0;
+        bool ok = swapPositions(buffer, firstMemoryPosition, secondMemoryPosition, firstWritten, secondWritten);
+
+        faults.traceSwap(firstMemoryPosition, secondMemoryPosition, firstWritten, secondWritten);
+
+        if (!ok)
+        {
+            faults.record(buffer, firstMemoryPosition, sequence);
+            faults.record(buffer, secondMemoryPosition, sequence);
+        }
+
+        return ok;
+    };
+
+    while (!deadline.expired())
+    {
+        faults.batchSequence = memPositionGenerator.position();
+        faults.beginTraceBatch();
+
+        bool ok = true;
+        long long latencyNanos = timeOperation(replayOperation, ok);
+        long long errors = !ok;
+
+        for (int i = 1; i < stressBatch; i++)
+        {
+            errors += !replayOperation();
+        }
+
+        if (swap)
+        {
+            recordBatch(stats, errors, swapBytesRead, swapBytesWritten, latencyNanos);
+        } else {
+            recordBatch(stats, errors, invertBytesRead, invertBytesWritten, latencyNanos);
+        }
+
+        faults.endTraceBatch();
+    }
+}
+
+// Roda a thread com a recuperacao de SIGBUS armada na faixa dela. Um SIGBUS em uma pagina da faixa
+// abandona a thread no meio do lote, registra a pagina e retorna true para quem chamou decidir se recomeca.
+// As threads de estresse nao tem objetos com destrutor vivos nos acessos ao buffer, o que o siglongjmp exige.
+template <typename Body>
+bool runRecoverable(volatile char * buffer, Range range, FaultLog& faults, Body body)
+{
+    #ifdef __linux__
+        RecoveryPoint point;
+
+        if (sigsetjmp(point.jump, 1) != 0)
+        {
+            faults.recordSigbus(buffer, point.address, point.code);
+            return true;
+        }
+
+        armRecovery(point, buffer + range.startIndex, buffer + range.finalIndex);
+        body();
+        disarmRecovery();
+    #else
+        body();
+    #endif
+
+    return false;
+}
+
+// Fecha o trace e mostra o tamanho gravado e os lotes que ficaram de fora
+void finishTrace(TraceWriter& trace, const std::string& path, std::ostream * output)
+{
+    trace.finish();
+
+    if (!output) return;
+
+    if (!trace.error().empty())
+    {
+        *output << "\nGravação do trace falhou: " << trace.error() << std::endl;
+        return;
+    }
+
+    *output << "\nTrace gravado em " << path << " (" << trace.writtenBytes() / (1024.0 * 1024.0) << " MiB";
+    if (trace.droppedBlocks() > 0) *output << ", " << trace.droppedBlocks() << " lotes descartados";
+    if (trace.droppedFaults() > 0) *output << ", " << trace.droppedFaults() << " falhas fora do trace";
+    *output << "), leia com mem-stress-trace" << std::endl;
+}
+
+// Soma um contador de todos os blocos
+long long sumStats(const std::vector<ThreadStats>& stats, std::atomic<long long> ThreadStats::* counter)
+{
+    long long total = 0;
+
+    for (const ThreadStats& threadStats : stats) total += (threadStats.*counter).load(std::memory_order_relaxed);
+
+    return total;
+}
+
+// Fases de um processo do estresse multiprocesso, na memoria compartilhada
+enum class WorkerPhase : int
+{
+    Starting = 0,
+    Filled = 1,
+    Finished = 2,
+    Failed = 3
+};
+
+// Falha e pagina isolada como ficam na memoria compartilhada, sem std::string
+struct SharedFault
+{
+    int thread;
+    long long offset;
+    uintptr_t virtualAddress;
+    unsigned long long physicalAddress;
+    double seconds;
+    unsigned long long sequence;
+};
+
+struct SharedBadPage
+{
+    int thread;
+    long long offset;
+    uintptr_t virtualAddress;
+    unsigned long long physicalAddress;
+    double seconds;
+    char action[96];
+    bool sigbus;
+};
+
+// Contadores de uma thread global, escritos pelo processo dono durante a execucao. As falhas e as paginas
+// so sao copiadas no fim; de um processo que caiu restam os contadores.
+struct SharedThread
+{
+    ThreadStats stats;
+
+    int faultCount;
+    SharedFault faults[maxFaultsPerThread];
+    int badPageCount;
+    SharedBadPage badPages[maxFaultsPerThread];
+};
+
+// Alocacao e preenchimento de um processo
+struct alignas(64) SharedProcess
+{
+    std::atomic<int> phase;
+    long long bufferSize;
+    double allocationSeconds;
+    double fillSeconds;
+    double residencyBefore;
+    double residencyAfter;
+    bool locked;
+    char lockError[160];
+    char error[160];
+};
+
+// Largada e parada comuns: o pai grava o inicio e o prazo (ns do steady_clock) antes de liberar a largada
+struct alignas(64) ProcessControl
+{
+    std::atomic<bool> start;
+    std::atomic<bool> stop;
+    long long startNanos;
+    long long finishNanos;
+};
+
+// Intervalo entre as consultas de um processo a largada e do pai ao preenchimento
+const std::chrono::milliseconds processPollTime(10);
+
+void copyText(char * target, size_t size, const std::string& text)
+{
+    std::strncpy(target, text.c_str(), size - 1);
+    target[size - 1] = '\0';
+}
+
+std::chrono::time_point<std::chrono::steady_clock> steadyTime(long long nanos)
+{
+    return std::chrono::time_point<std::chrono::steady_clock>(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(nanos)));
+}
+
+long long steadyNanos(std::chrono::time_point<std::chrono::steady_clock> time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+} // namespace
+
+// Memoria compartilhada do estresse multiprocesso, montada pelo pai antes do fork
+struct ProcessBoard
+{
+    ProcessControl * control = nullptr;
+    SharedProcess * processes = nullptr;
+    SharedThread * threads = nullptr;
+    int processCount = 0;
+    int threadCount = 0;
+
+    // Tamanho do buffer inteiro, dividido entre as threads globais como no estresse em um processo
+    long long bufferSize = 0;
+
+    // Threads globais do processo
+    Range processThreads(int process) const
+    {
+        return partitionRange(threadCount, processCount, process);
+    }
+
+    // Faixa de uma thread global no buffer inteiro, a mesma do estresse em um processo
+    Range threadRange(long long thread) const
+    {
+        return partitionRange(bufferSize, threadCount, static_cast<int>(thread), getPageSize());
+    }
+
+    // Fatia do processo no buffer inteiro: as faixas das suas threads, lado a lado
+    Range processSlice(int process) const
+    {
+        Range threads = processThreads(process);
+
+        return {threadRange(threads.startIndex).startIndex, threadRange(threads.finalIndex - 1).finalIndex};
+    }
+
+    // Copia os contadores das threads de todos os processos para o formato do estresse em um processo
+    void snapshot(std::vector<ThreadStats>& stats) const
+    {
+        for (int i = 0; i < threadCount; i++)
+        {
+            const ThreadStats& shared = threads[i].stats;
+            ThreadStats& copy = stats[i];
+
+            auto load = [](const std::atomic<long long>& counter) { return counter.load(std::memory_order_relaxed); };
+
+            copy.operations.store(load(shared.operations));
+            copy.bytesRead.store(load(shared.bytesRead));
+            copy.bytesWritten.store(load(shared.bytesWritten));
+            copy.errors.store(load(shared.errors));
+            copy.maxLatencyNanos.store(load(shared.maxLatencyNanos));
+            copy.quarantinedPages.store(load(shared.quarantinedPages));
+            copy.latencySumNanos.store(load(shared.latencySumNanos));
+
+            for (int bucket = 0; bucket < latencyBucketCount; bucket++) copy.latencyBuckets[bucket].store(load(shared.latencyBuckets[bucket]));
+        }
+    }
+};
+
+StressSession::StressSession(StressConfig config)
+    : sessionConfig(config), output(nullptr), stopRequested(false)
+{
+}
+
+void StressSession::setOutput(std::ostream * output)
+{
+    this->output = output;
+}
+
+void StressSession::stop()
+{
+    stopRequested.store(true);
+}
+
+std::string StressSession::resumeFrom(const StressCheckpoint& checkpoint)
+{
+    if (checkpoint.phase != "estresse") return "fase \"" + checkpoint.phase + "\" não pode ser continuada";
+    if (checkpoint.elapsedSeconds >= checkpoint.durationSeconds) return "o checkpoint já cobre a duração inteira";
+
+    // Mesmo tamanho e mesmas threads, assim cada thread retoma a propria faixa e as paginas isoladas nela
+    sessionConfig.mode = StressMode::Stress;
+    sessionConfig.sizeBytes = checkpoint.bufferSize;
+    sessionConfig.threads = static_cast<int>(checkpoint.threads.size());
+    sessionConfig.duration = std::chrono::seconds(static_cast<long long>(checkpoint.durationSeconds));
+
+    resumeState = checkpoint;
+    return "";
+}
+
+const StressResults& StressSession::run()
+{
+    RunDeadline deadline(std::chrono::steady_clock::now(), stopRequested);
+
+    selectKernels(sessionConfig.kernelIsa);
+    installSigbusHandler();
+    placeThreads();
+
+    int threadCount = sessionResults.threads;
+
+    if (output)
+    {
+        *output << "CPU: " << describeCpuFeatures() << std::endl;
+        *output << "Kernels: " << describeKernelSelection() << "\n" << std::endl;
+    }
+
+    if (sessionConfig.mode == StressMode::Churn)
+    {
+        // O churn nao usa o buffer principal, a memoria vem e vai durante a execucao
+        deadline = RunDeadline(std::chrono::steady_clock::now() + sessionConfig.duration, stopRequested);
+
+        EdacMonitor monitor("churn", sessionConfig.reportSeconds);
+
+        sessionResults.churn = runChurn(threadCount, sessionResults.placement, deadline, sessionConfig.churnMethod,
+            sessionConfig.churnMaxChunkSize, sessionConfig.churnRate, sessionConfig.seed, sessionConfig.reportSeconds, output);
+
+        sessionResults.edacPhases.push_back(monitor.finish(0));
+        reportEdac();
+
+        return sessionResults;
+    }
+
+    if (sessionConfig.mode == StressMode::Stress && sessionConfig.processes > 1)
+    {
+        runProcesses();
+
+        return sessionResults;
+    }
+
+    if (!allocateBuffer()) return sessionResults;
+
+    // A continuacao de um checkpoint roda so o tempo que faltava
+    std::chrono::duration<double> remaining = std::chrono::duration<double>(sessionConfig.duration)
+        - std::chrono::duration<double>(resumeState.elapsedSeconds);
+
+    if (output && !resumeState.threads.empty())
+    {
+        long long operations = 0;
+        long long errors = 0;
+
+        for (const ThreadCheckpoint& state : resumeState.threads)
+        {
+            operations += state.operations;
+            errors += state.errors;
+        }
+
+        *output << "\nContinuando do checkpoint: " << static_cast<long long>(resumeState.elapsedSeconds) << " s de "
+            << sessionConfig.duration.count() << " s já executados, " << operations << " operações, " << errors << " erros" << std::endl;
+    }
+
+    deadline = RunDeadline(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(remaining),
+        stopRequested);
+    auto startTime = std::chrono::steady_clock::now();
+
+    EdacMonitor monitor(phaseName(sessionConfig.mode), sessionConfig.reportSeconds);
+
+    switch (sessionConfig.mode)
+    {
+        case StressMode::Ramp:
+            if (output) *output << std::endl;
+            sessionResults.rampSteps = runRamp(*buffer, threadCount, sessionResults.placement, output);
+            break;
+
+        case StressMode::Interleave:
+            if (output) *output << std::endl;
+            sessionResults.interleave = runInterleave(*buffer, threadCount, sessionResults.placement, output);
+            break;
+
+        case StressMode::Scaling:
+            sessionResults.scaling = runScalingSweep(*buffer, cpuTopology(), sessionConfig.scalingKernels, sessionConfig.seed, output);
+            break;
+
+        case StressMode::Pressure:
+            sessionResults.pressure = runPressure(*buffer, threadCount, sessionResults.placement, deadline, sessionConfig.targetGbps,
+                sessionConfig.targetOps, sessionConfig.seed, sessionConfig.reportSeconds, output);
+            break;
+
+        case StressMode::Replay:
+            runReplay(deadline);
+            break;
+
+        case StressMode::Mixed:
+            sessionResults.mixed = runMixed(*buffer, threadCount, sessionResults.placement, deadline, sessionConfig.mixed,
+                sessionConfig.seed, sessionConfig.reportSeconds, output);
+
+            sessionResults.operations = sessionResults.mixed.reads + sessionResults.mixed.writes;
+            sessionResults.errors = sessionResults.mixed.errors;
+            sessionResults.faults = sessionResults.mixed.faults;
+            break;
+
+        default:
+            runStress(deadline);
+            break;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    sessionResults.elapsedSeconds = elapsed.count() + resumeState.elapsedSeconds;
+
+    sessionResults.edacPhases.push_back(monitor.finish(phaseTraffic()));
+
+    if (sessionConfig.mode == StressMode::Stress || sessionConfig.mode == StressMode::Replay || sessionConfig.mode == StressMode::Mixed)
+    {
+        // O DIMM apontado pelo EDAC na fase de estresse acompanha cada falha
+        sessionResults.edacIncreased = sessionResults.edacPhases.back().increased;
+
+        std::string dimmLabel = suspectDimmLabel(readEdacDimms(), sessionResults.edacIncreased);
+        for (FaultRecord& fault : sessionResults.faults) fault.dimmLabel = dimmLabel;
+
+        reportFaults();
+    }
+
+    reportEdac();
+
+    if (output) *output << std::endl;
+
+    sessionResults.residencyAfter = buffer->residency();
+    reportResidency("depois do estresse", sessionResults.residencyAfter);
+
+    buffer.reset();
+
+    return sessionResults;
+}
+
+// Define a quantidade de threads e a CPU de cada uma a partir da topologia
+void StressSession::placeThreads()
+{
+    const CpuTopology& topology = cpuTopology();
+
+    sessionResults.threads = sessionConfig.threads > 0
+        ? sessionConfig.threads
+        : defaultThreadCount(topology, sessionConfig.placement);
+
+    sessionResults.placement = planPlacement(topology, sessionConfig.placement, sessionResults.threads);
+
+    if (!output) return;
+
+    *output << "Topologia: " << describeTopology(topology) << std::endl;
+    *output << "Threads: " << sessionResults.threads;
+
+    if (sessionResults.placement.empty())
+    {
+        *output << " (sem afinidade)" << std::endl;
+        return;
+    }
+
+    *output << " (CPUs:";
+    for (int cpu : sessionResults.placement) *output << " " << cpu;
+    *output << ")" << std::endl;
+}
+
+// Aloca e preenche o buffer, false se o backend pedido nao pode ser mapeado
+bool StressSession::allocateBuffer()
+{
+    int threadCount = sessionResults.threads;
+
+    sessionResults.bufferSize = sessionConfig.sizeBytes > 0
+        ? sessionConfig.sizeBytes
+        : calculateBufferSize(sessionConfig.percentLimit);
+
+    if (output) *output << "Alocando o buffer de memória... " << std::flush;
+
+    auto allocationStart = std::chrono::steady_clock::now();
+
+    buffer.reset(new Buffer(sessionResults.bufferSize, sessionConfig.lockMemory, sessionConfig.prefault, sessionConfig.backend,
+        sessionConfig.backendPath));
+
+    if (!buffer->error().empty())
+    {
+        sessionResults.bufferError = buffer->error();
+        if (output) *output << "\nNão foi possível mapear o buffer: " << buffer->error() << std::endl;
+
+        buffer.reset();
+        return false;
+    }
+
+    // Nos backends de arquivo o tamanho sobe para o bloco do sistema de arquivos
+    sessionResults.bufferSize = buffer->size();
+
+    // Sem pagemap a sondagem de interleave so confia nos bits do endereco virtual dentro de paginas enormes
+    if (sessionConfig.mode == StressMode::Interleave) buffer->adviseHugePages();
+
+    sessionResults.locked = buffer->locked();
+    sessionResults.lockError = buffer->lockError();
+
+    if (output && !buffer->lockError().empty())
+    {
+        *output << "\nNão foi possível travar o buffer na RAM: " << buffer->lockError() << std::endl;
+
+        std::string limit = describeMemlockLimit();
+        if (!limit.empty()) *output << "Limite RLIMIT_MEMLOCK (soft/hard): " << limit << std::endl;
+
+        *output << "Continuando sem trava, o buffer pode ir para o swap." << std::endl;
+    }
+
+    EdacMonitor monitor("preenchimento", sessionConfig.reportSeconds);
+
+    buffer->prefault(threadCount, sessionResults.placement);
+
+    auto fillStart = std::chrono::steady_clock::now();
+
+    if (output) *output << "Preenchendo o buffer de memória... " << std::flush;
+
+    buffer->fill(threadCount, sessionResults.placement);
+
+    auto fillEnd = std::chrono::steady_clock::now();
+
+    sessionResults.allocationSeconds = std::chrono::duration<double>(fillStart - allocationStart).count();
+    sessionResults.fillSeconds = std::chrono::duration<double>(fillEnd - fillStart).count();
+
+    sessionResults.edacPhases.push_back(monitor.finish(sessionResults.bufferSize));
+
+    if (output)
+    {
+        *output << "Memória preenchida!\n" << std::endl;
+        *output << "Tempo de alocação e page faults (s): " << sessionResults.allocationSeconds << std::endl;
+        *output << "Tempo de preenchimento (s): " << sessionResults.fillSeconds
+            << " (" << (sessionResults.bufferSize / 1e9) / sessionResults.fillSeconds << " GB/s)" << std::endl;
+    }
+
+    sessionResults.residencyBefore = buffer->residency();
+    reportResidency("antes do estresse", sessionResults.residencyBefore);
+
+    return true;
+}
+
+void StressSession::reportResidency(const char * phase, double residency)
+{
+    if (!output) return;
+
+    if (residency < 0)
+    {
+        *output << "Residência do buffer na RAM (" << phase << "): indisponível" << std::endl;
+        return;
+    }
+
+    *output << "Residência do buffer na RAM (" << phase << "): " << residency << "%" << std::endl;
+
+    if (residency < 100.0)
+    {
+        *output << "Aviso: parte do buffer está fora da RAM, a medição inclui acessos ao swap." << std::endl;
+    }
+}
+
+// Estresse padrao: metade das threads inverte e metade troca posicoes aleatorias. Cada thread fica com
+// a sua faixa do buffer, assim as escritas conferidas nao disputam posicoes e dispensam mutex.
+void StressSession::runStress(const RunDeadline& deadline)
+{
+    int threadCount = sessionResults.threads;
+    std::vector<ThreadStats> stats(threadCount);
+    std::vector<FaultLog> faults(threadCount);
+    std::vector<CheckpointSlot> checkpoints(threadCount);
+
+    // Na continuacao o inicio recua o tempo ja executado, assim os instantes e as vazoes valem para a execucao toda
+    auto startTime = std::chrono::steady_clock::now() - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(resumeState.elapsedSeconds));
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        faults[i].thread = i;
+        faults[i].startTime = startTime;
+        faults[i].stats = &stats[i];
+
+        if (!sessionConfig.checkpointFile.empty()) faults[i].checkpoint = &checkpoints[i];
+    }
+
+    std::unique_ptr<TraceWriter> trace;
+
+    if (!sessionConfig.traceFile.empty())
+    {
+        trace = std::make_unique<TraceWriter>(sessionConfig.traceFile, threadCount, traceRingBlocks, traceBlockWords,
+            sessionConfig.traceMaxBytes);
+
+        for (int i = 0; i < threadCount && trace->error().empty(); i++) faults[i].trace = &trace->ring(i);
+    }
+
+    for (size_t i = 0; i < resumeState.threads.size(); i++)
+    {
+        const ThreadCheckpoint& state = resumeState.threads[i];
+
+        stats[i].operations.store(state.operations);
+        stats[i].bytesRead.store(state.bytesRead);
+        stats[i].bytesWritten.store(state.bytesWritten);
+        stats[i].errors.store(state.errors);
+        stats[i].maxLatencyNanos.store(state.maxLatencyNanos);
+        stats[i].quarantinedPages.store(state.quarantinedPages);
+        stats[i].latencySumNanos.store(state.latencySumNanos);
+
+        for (size_t bucket = 0; bucket < state.latencyBuckets.size() && bucket < latencyBucketCount; bucket++)
+        {
+            stats[i].latencyBuckets[bucket].store(state.latencyBuckets[bucket]);
+        }
+
+        faults[i].records = state.faults;
+        faults[i].badPages = state.badPages;
+        faults[i].generatorState = state.generatorState;
+    }
+
+    // Monta o checkpoint com o ultimo estado que cada thread deixou
+    std::string checkpointError;
+
+    auto writeCheckpoint = [&](double elapsedSeconds) {
+        StressCheckpoint checkpoint;
+        checkpoint.bufferSize = sessionResults.bufferSize;
+        checkpoint.durationSeconds = std::chrono::duration<double>(sessionConfig.duration).count();
+        checkpoint.elapsedSeconds = elapsedSeconds;
+
+        for (CheckpointSlot& slot : checkpoints) checkpoint.threads.push_back(slot.state());
+
+        std::string error = saveCheckpoint(sessionConfig.checkpointFile, checkpoint);
+        if (checkpointError.empty()) checkpointError = error;
+    };
+
+    TelemetryReader telemetry;
+    TelemetrySample lastSample;
+    sessionResults.telemetry.clear();
+
+    MetricsExporter metrics(sessionConfig.metricsFile, sessionConfig.metricsPort);
+
+    // A porta ocupada aparece ja no inicio, uma execucao longa nao deve descobrir isso no fim
+    std::string exporterError = metrics.error();
+    if (output && !exporterError.empty()) *output << "Exportação de métricas falhou: " << exporterError << std::endl;
+
+    if (metrics.enabled())
+    {
+        metrics.publish(formatStressMetrics(stats, sessionResults.placement, lastSample, true));
+    }
+
+    std::thread reporter([&]() {
+        auto lastTime = std::chrono::steady_clock::now();
+        long long lastOperations = sumStats(stats, &ThreadStats::operations);
+        long long lastBytes = sumStats(stats, &ThreadStats::bytesRead) + sumStats(stats, &ThreadStats::bytesWritten);
+
+        // O checkpoint eh pedido as threads e gravado no relatorio seguinte, quando todas ja copiaram o estado
+        auto nextCheckpoint = lastTime + std::chrono::seconds(sessionConfig.checkpointSeconds);
+        bool checkpointRequested = false;
+        double checkpointSeconds = 0;
+
+        while (!deadline.expired())
+        {
+            deadline.waitUntil(std::chrono::steady_clock::now() + std::chrono::seconds(sessionConfig.reportSeconds));
+
+            // Vazao do ultimo intervalo, e nao a media desde o inicio, para a queda por throttling aparecer
+            auto now = std::chrono::steady_clock::now();
+            double interval = std::chrono::duration<double>(now - lastTime).count();
+            long long operations = sumStats(stats, &ThreadStats::operations);
+            long long bytes = sumStats(stats, &ThreadStats::bytesRead) + sumStats(stats, &ThreadStats::bytesWritten);
+
+            TelemetrySample sample = telemetry.sample();
+            sample.seconds = std::chrono::duration<double>(now - startTime).count();
+            sample.opsPerSecond = interval > 0 ? (operations - lastOperations) / interval : 0;
+            sample.gbps = interval > 0 ? (bytes - lastBytes) / 1e9 / interval : 0;
+
+            // O intervalo cortado pelo fim da execucao pegaria as threads parando e falsearia a queda de vazao
+            if (!deadline.expired() || interval >= sessionConfig.reportSeconds * 0.5) sessionResults.telemetry.push_back(sample);
+
+            lastTime = now;
+            lastOperations = operations;
+            lastBytes = bytes;
+            lastSample = sample;
+
+            if (metrics.enabled()) metrics.publish(formatStressMetrics(stats, sessionResults.placement, sample, true));
+
+            if (!sessionConfig.checkpointFile.empty())
+            {
+                bool ready = std::all_of(checkpoints.begin(), checkpoints.end(), [](const CheckpointSlot& slot) { return slot.ready(); });
+
+                if (checkpointRequested && ready)
+                {
+                    writeCheckpoint(checkpointSeconds);
+                    checkpointRequested = false;
+                    nextCheckpoint = now + std::chrono::seconds(sessionConfig.checkpointSeconds);
+                }
+                else if (!checkpointRequested && now >= nextCheckpoint)
+                {
+                    for (CheckpointSlot& slot : checkpoints) slot.request();
+                    checkpointRequested = true;
+                    checkpointSeconds = sample.seconds;
+                }
+            }
+
+            if (!output) continue;
+
+            std::ios::fmtflags flags = output->flags();
+            std::streamsize precision = output->precision();
+
+            *output << "Operações: " << operations
+                << " (" << static_cast<long long>(sample.opsPerSecond) << " ops/s, "
+                << std::fixed << std::setprecision(2) << sample.gbps << " GB/s)";
+
+            output->flags(flags);
+            output->precision(precision);
+
+            *output << ", erros: " << sumStats(stats, &ThreadStats::errors);
+
+            if (sessionConfig.quarantine != QuarantineMode::None)
+            {
+                *output << ", páginas isoladas: " << sumStats(stats, &ThreadStats::quarantinedPages);
+            }
+
+            std::string telemetryText = describeTelemetry(sample);
+            if (!telemetryText.empty()) *output << ", " << telemetryText;
+
+            *output << "\r" << std::flush;
+        }
+    });
+
+    // Faixas alinhadas em paginas, assim cada pagina isolada pertence a uma thread so
+    runParallel(threadCount, [&](int index) {
+        Range range = partitionRange(buffer->size(), threadCount, index, getPageSize());
+
+        if (range.startIndex >= range.finalIndex)
+        {
+            faults[index].serveCheckpoint(nullptr, true);
+            return;
+        }
+
+        faults[index].quarantine.configure(sessionConfig.quarantine, range, getPageSize());
+
+        for (const BadPage& page : faults[index].badPages) faults[index].quarantine.restore(page.offset);
+
+        uint64_t seed = streamSeed(sessionConfig.seed, index);
+
+        auto stress = [&]() {
+            if (index % 2 == 0)
+            {
+                invertBinaryValueThread(buffer->data(), range, seed, deadline, stats[index], faults[index]);
+            } else {
+                swapValuesThread(buffer->data(), range, seed, deadline, stats[index], faults[index]);
+            }
+        };
+
+        // Depois de um SIGBUS a thread refaz o lote interrompido sem a pagina envenenada
+        while (runRecoverable(buffer->data(), range, faults[index], stress)) {}
+    }, sessionResults.placement);
+
+    reporter.join();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+
+    if (trace) finishTrace(*trace, sessionConfig.traceFile, output);
+
+    // O arquivo fica com o resultado final para o coletor, marcado como encerrado
+    if (metrics.enabled())
+    {
+        lastSample.seconds = elapsed.count();
+        metrics.publish(formatStressMetrics(stats, sessionResults.placement, lastSample, false));
+    }
+
+    sessionResults.operations = sumStats(stats, &ThreadStats::operations);
+    sessionResults.errors = sumStats(stats, &ThreadStats::errors);
+
+    collectThreadResults(stats, elapsed.count());
+
+    sessionResults.telemetrySummary = summarizeTelemetry(sessionResults.telemetry);
+    if (telemetry.available()) reportTelemetry();
+
+    if (output && metrics.error() != exporterError) *output << "\nExportação de métricas falhou: " << metrics.error() << std::endl;
+
+    // Interrompido, o checkpoint fica com o estado final de todas as threads; no prazo, o estresse acabou
+    if (!sessionConfig.checkpointFile.empty())
+    {
+        if (stopRequested.load())
+        {
+            writeCheckpoint(elapsed.count());
+            if (output && checkpointError.empty()) *output << "\nCheckpoint gravado em " << sessionConfig.checkpointFile << ", continue com --resume" << std::endl;
+        } else {
+            std::remove(sessionConfig.checkpointFile.c_str());
+        }
+
+        if (output && !checkpointError.empty()) *output << "\nGravação do checkpoint falhou: " << checkpointError << std::endl;
+    }
+
+    sessionResults.faults.clear();
+    sessionResults.badPages.clear();
+
+    for (const FaultLog& log : faults)
+    {
+        sessionResults.faults.insert(sessionResults.faults.end(), log.records.begin(), log.records.end());
+        sessionResults.badPages.insert(sessionResults.badPages.end(), log.badPages.begin(), log.badPages.end());
+    }
+}
+
+// Uma thread so, presa na CPU que a thread original usou, reexecuta a sequencia dela na mesma faixa do buffer
+void StressSession::runReplay(const RunDeadline& deadline)
+{
+    int threadCount = sessionResults.threads;
+    ReplaySummary& summary = sessionResults.replay;
+
+    summary = ReplaySummary();
+    summary.thread = sessionConfig.replayThread;
+    summary.swap = summary.thread % 2 != 0;
+
+    if (sessionConfig.seed == 0)
+    {
+        if (output) *output << "O replay precisa da semente do estresse original" << std::endl;
+        return;
+    }
+
+    if (summary.thread < 0 || summary.thread >= threadCount)
+    {
+        if (output) *output << "Thread " << summary.thread << " inexistente, o estresse tinha " << threadCount << " threads" << std::endl;
+        return;
+    }
+
+    summary.range = partitionRange(buffer->size(), threadCount, summary.thread, getPageSize());
+
+    // A thread do replay fica na CPU da thread original
+    std::vector<int> placement;
+    if (!sessionResults.placement.empty()) placement.push_back(sessionResults.placement[summary.thread % sessionResults.placement.size()]);
+
+    if (output)
+    {
+        *output << "Replay da thread " << summary.thread << " (" << (summary.swap ? "troca" : "inversão") << "), posições "
+            << summary.range.startIndex << " a " << summary.range.finalIndex - 1 << ", a partir da sequência " << sessionConfig.replayFrom;
+
+        if (sessionConfig.replayCount > 0) *output << ", janela de " << sessionConfig.replayCount << " operações repetida";
+
+        *output << std::endl;
+    }
+
+    ThreadStats stats;
+    FaultLog faults;
+    std::atomic<long long> passes{0};
+
+    faults.thread = summary.thread;
+    faults.startTime = std::chrono::steady_clock::now();
+    faults.stats = &stats;
+
+    std::unique_ptr<TraceWriter> trace;
+
+    if (!sessionConfig.traceFile.empty())
+    {
+        trace = std::make_unique<TraceWriter>(sessionConfig.traceFile, 1, traceRingBlocks, traceBlockWords, sessionConfig.traceMaxBytes);
+        if (trace->error().empty()) faults.trace = &trace->ring(0);
+    }
+
+    std::thread reporter([&]() {
+        while (!deadline.expired())
+        {
+            deadline.waitUntil(std::chrono::steady_clock::now() + std::chrono::seconds(sessionConfig.reportSeconds));
+
+            if (!output) continue;
+
+            *output << "Operações: " << stats.operations.load(std::memory_order_relaxed)
+                << ", passagens pela janela: " << passes.load(std::memory_order_relaxed)
+                << ", erros: " << stats.errors.load(std::memory_order_relaxed) << "\r" << std::flush;
+        }
+    });
+
+    runParallel(1, [&](int) {
+        auto replay = [&]() {
+            replayThread(buffer->data(), summary.range, streamSeed(sessionConfig.seed, summary.thread), summary.swap,
+                sessionConfig.replayFrom, sessionConfig.replayCount, deadline, stats, faults, passes);
+        };
+
+        // Sem a pagina envenenada a sequencia nao pode seguir igual a original, o replay para no SIGBUS
+        if (runRecoverable(buffer->data(), summary.range, faults, replay)) stopRequested.store(true);
+    }, placement);
+
+    reporter.join();
+
+    if (trace) finishTrace(*trace, sessionConfig.traceFile, output);
+
+    summary.operations = stats.operations.load();
+    summary.errors = stats.errors.load();
+    summary.passes = passes.load();
+    summary.bytes = stats.bytesRead.load() + stats.bytesWritten.load();
+
+    sessionResults.operations = summary.operations;
+    sessionResults.errors = summary.errors;
+    sessionResults.faults = faults.records;
+    sessionResults.badPages = faults.badPages;
+
+    if (output) *output << "\n" << std::endl;
+}
+
+// Estresse multiprocesso: o pai divide o buffer e as threads entre os processos, libera a largada quando
+// todos preencheram a sua fatia e agrega os contadores da memoria compartilhada no mesmo relatorio do
+// estresse em um processo. Um processo que cai (OOM killer, SIGBUS fora das threads de estresse) fica
+// registrado e os demais seguem ate o prazo.
+void StressSession::runProcesses()
+{
+    int processCount = sessionConfig.processes;
+
+    // Cada processo precisa de pelo menos uma thread
+    sessionResults.threads = std::max(sessionResults.threads, processCount);
+    int threadCount = sessionResults.threads;
+
+    long long totalSize = sessionConfig.sizeBytes > 0
+        ? sessionConfig.sizeBytes
+        : calculateBufferSize(sessionConfig.percentLimit);
+
+    // Controle, processos e threads, cada parte em linhas de cache proprias
+    size_t controlSize = sizeof(ProcessControl);
+    size_t processesSize = processCount * sizeof(SharedProcess);
+    SharedMemory shared(controlSize + processesSize + threadCount * sizeof(SharedThread));
+
+    if (!shared.error().empty())
+    {
+        if (output) *output << "Memória compartilhada dos processos falhou: " << shared.error() << std::endl;
+        return;
+    }
+
+    char * base = static_cast<char *>(shared.data());
+
+    ProcessBoard board;
+    board.control = new (base) ProcessControl();
+    board.processes = reinterpret_cast<SharedProcess *>(base + controlSize);
+    board.threads = reinterpret_cast<SharedThread *>(base + controlSize + processesSize);
+    board.processCount = processCount;
+    board.threadCount = threadCount;
+
+    board.bufferSize = totalSize;
+
+    for (int i = 0; i < processCount; i++)
+    {
+        Range slice = board.processSlice(i);
+
+        new (&board.processes[i]) SharedProcess();
+        board.processes[i].bufferSize = slice.finalIndex - slice.startIndex;
+    }
+
+    for (int i = 0; i < threadCount; i++) new (&board.threads[i]) SharedThread();
+
+    ProcessControl& control = *board.control;
+
+    if (output)
+    {
+        *output << "Processos: " << processCount << " (" << threadCount << " threads no total)" << std::endl;
+        *output << "Alocando e preenchendo o buffer de memória nos processos... " << std::flush;
+    }
+
+    // Os filhos saem sem esvaziar os buffers herdados, mas o que ja estava pendente sairia duas vezes
+    std::fflush(nullptr);
+
+    std::vector<int> pids;
+    std::vector<WorkerStatus> statuses(processCount);
+
+    for (int i = 0; i < processCount; i++)
+    {
+        std::string error;
+        int pid = forkWorker([this, i, &board]() { return runWorkerProcess(i, board); }, error);
+
+        if (pid < 0)
+        {
+            if (output) *output << "\nNão foi possível criar o processo " << i << ": " << error << std::endl;
+
+            for (int started : pids) killWorker(started);
+            for (int started : pids) pollWorker(started, true);
+            return;
+        }
+
+        pids.push_back(pid);
+    }
+
+    auto pollWorkers = [&](bool wait) {
+        for (int i = 0; i < processCount; i++)
+        {
+            if (statuses[i].running) statuses[i] = pollWorker(pids[i], wait);
+        }
+    };
+
+    auto phaseOf = [&](int process) {
+        return static_cast<WorkerPhase>(board.processes[process].phase.load(std::memory_order_acquire));
+    };
+
+    // O preenchimento acompanha a queda de um processo, que nunca chegaria ao fim dele
+    EdacMonitor fillMonitor("preenchimento", sessionConfig.reportSeconds);
+
+    while (!stopRequested.load())
+    {
+        pollWorkers(false);
+
+        bool settled = true;
+
+        for (int i = 0; i < processCount; i++)
+        {
+            if (statuses[i].running && phaseOf(i) == WorkerPhase::Starting) settled = false;
+        }
+
+        if (settled) break;
+
+        std::this_thread::sleep_for(processPollTime);
+    }
+
+    // Soma das fatias preenchidas, o tamanho do buffer que de fato foi estressado
+    long long filledSize = 0;
+    double residencyWeight = 0;
+    double residencySum = 0;
+    bool residencyKnown = true;
+
+    sessionResults.locked = true;
+
+    for (int i = 0; i < processCount; i++)
+    {
+        const SharedProcess& process = board.processes[i];
+
+        if (phaseOf(i) != WorkerPhase::Filled) continue;
+
+        filledSize += process.bufferSize;
+        sessionResults.allocationSeconds = std::max(sessionResults.allocationSeconds, process.allocationSeconds);
+        sessionResults.fillSeconds = std::max(sessionResults.fillSeconds, process.fillSeconds);
+        sessionResults.locked = sessionResults.locked && process.locked;
+        if (sessionResults.lockError.empty()) sessionResults.lockError = process.lockError;
+
+        if (process.residencyBefore < 0) residencyKnown = false;
+        residencySum += process.residencyBefore * process.bufferSize;
+        residencyWeight += process.bufferSize;
+    }
+
+    sessionResults.bufferSize = filledSize;
+    sessionResults.edacPhases.push_back(fillMonitor.finish(filledSize));
+
+    if (output)
+    {
+        *output << "Memória preenchida!\n" << std::endl;
+
+        for (int i = 0; i < processCount; i++)
+        {
+            const SharedProcess& process = board.processes[i];
+
+            if (phaseOf(i) == WorkerPhase::Failed)
+            {
+                *output << "Processo " << i << " falhou: " << process.error << std::endl;
+            }
+            else if (phaseOf(i) != WorkerPhase::Filled)
+            {
+                *output << "Processo " << i << " caiu no preenchimento: " << describeWorkerStatus(statuses[i]) << std::endl;
+            }
+        }
+
+        if (!sessionResults.lockError.empty())
+        {
+            *output << "Não foi possível travar o buffer na RAM: " << sessionResults.lockError << std::endl;
+            *output << "Continuando sem trava, o buffer pode ir para o swap." << std::endl;
+        }
+
+        *output << "Tempo de alocação e page faults (s): " << sessionResults.allocationSeconds << std::endl;
+        *output << "Tempo de preenchimento (s): " << sessionResults.fillSeconds;
+        if (sessionResults.fillSeconds > 0) *output << " (" << (filledSize / 1e9) / sessionResults.fillSeconds << " GB/s)";
+        *output << std::endl;
+    }
+
+    sessionResults.residencyBefore = residencyKnown && residencyWeight > 0 ? residencySum / residencyWeight : -1;
+    reportResidency("antes do estresse", sessionResults.residencyBefore);
+
+    // O inicio e o prazo vao antes da largada, cada processo monta o seu prazo a partir deles
+    auto startTime = std::chrono::steady_clock::now();
+    RunDeadline deadline(startTime + sessionConfig.duration, stopRequested);
+
+    control.startNanos = steadyNanos(startTime);
+    control.finishNanos = steadyNanos(deadline.finishTime());
+    control.start.store(true, std::memory_order_release);
+
+    EdacMonitor monitor("estresse", sessionConfig.reportSeconds);
+
+    std::vector<ThreadStats> stats(threadCount);
+
+    TelemetryReader telemetry;
+    TelemetrySample lastSample;
+    sessionResults.telemetry.clear();
+
+    MetricsExporter metrics(sessionConfig.metricsFile, sessionConfig.metricsPort);
+
+    std::string exporterError = metrics.error();
+    if (output && !exporterError.empty()) *output << "Exportação de métricas falhou: " << exporterError << std::endl;
+
+    if (metrics.enabled())
+    {
+        metrics.publish(formatStressMetrics(stats, sessionResults.placement, lastSample, true));
+    }
+
+    auto runningWorkers = [&]() {
+        return std::count_if(statuses.begin(), statuses.end(), [](const WorkerStatus& status) { return status.running; });
+    };
+
+    auto lastTime = startTime;
+    long long lastOperations = 0;
+    long long lastBytes = 0;
+
+    // O pai so le os contadores: o relatorio periodico e a mesma conta do estresse em um processo
+    while (!deadline.expired() && runningWorkers() > 0)
+    {
+        deadline.waitUntil(std::chrono::steady_clock::now() + std::chrono::seconds(sessionConfig.reportSeconds));
+
+        pollWorkers(false);
+        board.snapshot(stats);
+
+        auto now = std::chrono::steady_clock::now();
+        double interval = std::chrono::duration<double>(now - lastTime).count();
+        long long operations = sumStats(stats, &ThreadStats::operations);
+        long long bytes = sumStats(stats, &ThreadStats::bytesRead) + sumStats(stats, &ThreadStats::bytesWritten);
+
+        TelemetrySample sample = telemetry.sample();
+        sample.seconds = std::chrono::duration<double>(now - startTime).count();
+        sample.opsPerSecond = interval > 0 ? (operations - lastOperations) / interval : 0;
+        sample.gbps = interval > 0 ? (bytes - lastBytes) / 1e9 / interval : 0;
+
+        if (!deadline.expired() || interval >= sessionConfig.reportSeconds * 0.5) sessionResults.telemetry.push_back(sample);
+
+        lastTime = now;
+        lastOperations = operations;
+        lastBytes = bytes;
+        lastSample = sample;
+
+        if (metrics.enabled()) metrics.publish(formatStressMetrics(stats, sessionResults.placement, sample, true));
+
+        if (!output) continue;
+
+        std::ios::fmtflags flags = output->flags();
+        std::streamsize precision = output->precision();
+
+        *output << "Operações: " << operations
+            << " (" << static_cast<long long>(sample.opsPerSecond) << " ops/s, "
+            << std::fixed << std::setprecision(2) << sample.gbps << " GB/s)";
+
+        output->flags(flags);
+        output->precision(precision);
+
+        *output << ", erros: " << sumStats(stats, &ThreadStats::errors);
+
+        if (sessionConfig.quarantine != QuarantineMode::None)
+        {
+            *output << ", páginas isoladas: " << sumStats(stats, &ThreadStats::quarantinedPages);
+        }
+
+        *output << ", processos: " << runningWorkers() << " de " << processCount;
+
+        std::string telemetryText = describeTelemetry(sample);
+        if (!telemetryText.empty()) *output << ", " << telemetryText;
+
+        *output << "\r" << std::flush;
+    }
+
+    // Os processos param sozinhos no prazo; interrompido, o pai avisa
+    if (stopRequested.load()) control.stop.store(true);
+
+    pollWorkers(true);
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+    sessionResults.elapsedSeconds = elapsed.count();
+
+    board.snapshot(stats);
+
+    if (metrics.enabled())
+    {
+        lastSample.seconds = elapsed.count();
+        metrics.publish(formatStressMetrics(stats, sessionResults.placement, lastSample, false));
+    }
+
+    sessionResults.operations = sumStats(stats, &ThreadStats::operations);
+    sessionResults.errors = sumStats(stats, &ThreadStats::errors);
+
+    collectThreadResults(stats, elapsed.count());
+
+    sessionResults.telemetrySummary = summarizeTelemetry(sessionResults.telemetry);
+    if (telemetry.available()) reportTelemetry();
+
+    if (output && metrics.error() != exporterError) *output << "\nExportação de métricas falhou: " << metrics.error() << std::endl;
+
+    sessionResults.faults.clear();
+    sessionResults.badPages.clear();
+    sessionResults.processes.clear();
+
+    residencyWeight = 0;
+    residencySum = 0;
+    residencyKnown = true;
+
+    for (int i = 0; i < processCount; i++)
+    {
+        const SharedProcess& process = board.processes[i];
+        Range threads = board.processThreads(i);
+        WorkerPhase phase = phaseOf(i);
+
+        ProcessResult result;
+        result.process = i;
+        result.pid = pids[i];
+        result.firstThread = static_cast<int>(threads.startIndex);
+        result.threads = static_cast<int>(threads.finalIndex - threads.startIndex);
+        result.bufferSize = process.bufferSize;
+        result.failed = phase != WorkerPhase::Finished || statuses[i].signal != 0 || statuses[i].exitCode != 0;
+        result.status = phase == WorkerPhase::Failed ? std::string(process.error) : describeWorkerStatus(statuses[i]);
+
+        sessionResults.processes.push_back(result);
+
+        // As falhas e as paginas de um processo que caiu nao chegaram a ser copiadas
+        if (phase != WorkerPhase::Finished) continue;
+
+        for (long long thread = threads.startIndex; thread < threads.finalIndex; thread++)
+        {
+            const SharedThread& sharedThread = board.threads[thread];
+
+            for (int f = 0; f < sharedThread.faultCount; f++)
+            {
+                const SharedFault& sharedFault = sharedThread.faults[f];
+
+                FaultRecord fault;
+                fault.thread = sharedFault.thread;
+                fault.offset = sharedFault.offset;
+                fault.virtualAddress = sharedFault.virtualAddress;
+                fault.physicalAddress = sharedFault.physicalAddress;
+                fault.seconds = sharedFault.seconds;
+                fault.sequence = sharedFault.sequence;
+
+                sessionResults.faults.push_back(fault);
+            }
+
+            for (int p = 0; p < sharedThread.badPageCount; p++)
+            {
+                const SharedBadPage& sharedPage = sharedThread.badPages[p];
+
+                BadPage page;
+                page.thread = sharedPage.thread;
+                page.offset = sharedPage.offset;
+                page.virtualAddress = sharedPage.virtualAddress;
+                page.physicalAddress = sharedPage.physicalAddress;
+                page.seconds = sharedPage.seconds;
+                page.action = sharedPage.action;
+                page.sigbus = sharedPage.sigbus;
+
+                sessionResults.badPages.push_back(page);
+            }
+        }
+
+        if (process.residencyAfter < 0) residencyKnown = false;
+        residencySum += process.residencyAfter * process.bufferSize;
+        residencyWeight += process.bufferSize;
+    }
+
+    sessionResults.edacPhases.push_back(monitor.finish(phaseTraffic()));
+    sessionResults.edacIncreased = sessionResults.edacPhases.back().increased;
+
+    std::string dimmLabel = suspectDimmLabel(readEdacDimms(), sessionResults.edacIncreased);
+    for (FaultRecord& fault : sessionResults.faults) fault.dimmLabel = dimmLabel;
+
+    reportProcesses();
+    reportFaults();
+    reportEdac();
+
+    if (output) *output << std::endl;
+
+    sessionResults.residencyAfter = residencyKnown && residencyWeight > 0 ? residencySum / residencyWeight : -1;
+    reportResidency("depois do estresse", sessionResults.residencyAfter);
+}
+
+// Um processo do estresse multiprocesso, roda no filho: aloca e preenche a sua fatia, espera a largada e
+// roda as suas threads como o estresse em um processo, com os contadores na memoria compartilhada. Cada
+// thread global tem a semente, o kernel (inversao ou troca) e a faixa que teria sozinha, com a fatia do
+// processo no lugar do buffer inteiro, entao as posicoes e sequencias das falhas servem para o replay.
+int StressSession::runWorkerProcess(int process, ProcessBoard& board)
+{
+    SharedProcess& slot = board.processes[process];
+    ProcessControl& control = *board.control;
+
+    Range threads = board.processThreads(process);
+    Range slice = board.processSlice(process);
+    int threadCount = static_cast<int>(threads.finalIndex - threads.startIndex);
+
+    // As threads ficam nas CPUs que o posicionamento deu aos indices globais delas
+    std::vector<int> cpus;
+
+    for (long long thread = threads.startIndex; thread < threads.finalIndex && !sessionResults.placement.empty(); thread++)
+    {
+        cpus.push_back(sessionResults.placement[thread % sessionResults.placement.size()]);
+    }
+
+    auto allocationStart = std::chrono::steady_clock::now();
+
+    // Um arquivo por processo, os mapeamentos nao podem cair na mesma faixa do arquivo
+    std::string path = sessionConfig.backendPath.empty() ? "" : sessionConfig.backendPath + "." + std::to_string(process);
+
+    try
+    {
+        buffer.reset(new Buffer(slot.bufferSize, sessionConfig.lockMemory, sessionConfig.prefault, sessionConfig.backend, path));
+    }
+    catch (const std::bad_alloc&)
+    {
+        copyText(slot.error, sizeof(slot.error), "alocação de " + std::to_string(slot.bufferSize) + " bytes falhou");
+        slot.phase.store(static_cast<int>(WorkerPhase::Failed), std::memory_order_release);
+        return 1;
+    }
+
+    if (!buffer->error().empty())
+    {
+        copyText(slot.error, sizeof(slot.error), buffer->error());
+        slot.phase.store(static_cast<int>(WorkerPhase::Failed), std::memory_order_release);
+        return 1;
+    }
+
+    slot.bufferSize = buffer->size();
+
+    slot.locked = buffer->locked();
+    copyText(slot.lockError, sizeof(slot.lockError), buffer->lockError());
+
+    buffer->prefault(threadCount, cpus);
+
+    auto fillStart = std::chrono::steady_clock::now();
+    buffer->fill(threadCount, cpus);
+    auto fillEnd = std::chrono::steady_clock::now();
+
+    slot.allocationSeconds = std::chrono::duration<double>(fillStart - allocationStart).count();
+    slot.fillSeconds = std::chrono::duration<double>(fillEnd - fillStart).count();
+    slot.residencyBefore = buffer->residency();
+    slot.phase.store(static_cast<int>(WorkerPhase::Filled), std::memory_order_release);
+
+    while (!control.start.load(std::memory_order_acquire) && !control.stop.load())
+    {
+        std::this_thread::sleep_for(processPollTime);
+    }
+
+    RunDeadline deadline(steadyTime(control.finishNanos), control.stop);
+    std::vector<FaultLog> faults(threadCount);
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        faults[i].thread = static_cast<int>(threads.startIndex) + i;
+        faults[i].startTime = steadyTime(control.startNanos);
+        faults[i].stats = &board.threads[faults[i].thread].stats;
+    }
+
+    runParallel(threadCount, [&](int index) {
+        FaultLog& log = faults[index];
+        Range global = board.threadRange(log.thread);
+        Range range{global.startIndex - slice.startIndex, global.finalIndex - slice.startIndex};
+
+        if (range.startIndex >= range.finalIndex) return;
+
+        log.quarantine.configure(sessionConfig.quarantine, range, getPageSize());
+
+        uint64_t seed = streamSeed(sessionConfig.seed, log.thread);
+
+        auto stress = [&]() {
+            if (log.thread % 2 == 0)
+            {
+                invertBinaryValueThread(buffer->data(), range, seed, deadline, *log.stats, log);
+            } else {
+                swapValuesThread(buffer->data(), range, seed, deadline, *log.stats, log);
+            }
+        };
+
+        while (runRecoverable(buffer->data(), range, log, stress)) {}
+    }, cpus);
+
+    for (const FaultLog& log : faults)
+    {
+        SharedThread& shared = board.threads[log.thread];
+
+        shared.faultCount = 0;
+        shared.badPageCount = 0;
+
+        for (const FaultRecord& fault : log.records)
+        {
+            if (shared.faultCount >= static_cast<int>(maxFaultsPerThread)) break;
+
+            // Posicoes no buffer inteiro, como as do estresse em um processo
+            shared.faults[shared.faultCount++] = {fault.thread, fault.offset + slice.startIndex, fault.virtualAddress,
+                fault.physicalAddress, fault.seconds, fault.sequence};
+        }
+
+        for (const BadPage& page : log.badPages)
+        {
+            if (shared.badPageCount >= static_cast<int>(maxFaultsPerThread)) break;
+
+            SharedBadPage& sharedPage = shared.badPages[shared.badPageCount++];
+            sharedPage.thread = page.thread;
+            sharedPage.offset = page.offset + slice.startIndex;
+            sharedPage.virtualAddress = page.virtualAddress;
+            sharedPage.physicalAddress = page.physicalAddress;
+            sharedPage.seconds = page.seconds;
+            copyText(sharedPage.action, sizeof(sharedPage.action), page.action);
+            sharedPage.sigbus = page.sigbus;
+        }
+    }
+
+    slot.residencyAfter = buffer->residency();
+    slot.phase.store(static_cast<int>(WorkerPhase::Finished), std::memory_order_release);
+
+    return 0;
+}
+
+// Tabela dos processos com as threads, a fatia do buffer e como cada um terminou
+void StressSession::reportProcesses()
+{
+    if (!output || sessionResults.processes.empty()) return;
+
+    std::ios::fmtflags flags = output->flags();
+    std::streamsize precision = output->precision();
+
+    *output << "\nProcesso  PID       Threads   Buffer (MiB)  Situação\n";
+
+    for (const ProcessResult& result : sessionResults.processes)
+    {
+        std::string threads = std::to_string(result.firstThread);
+        if (result.threads > 1) threads += "-" + std::to_string(result.firstThread + result.threads - 1);
+
+        *output << std::left << std::setw(10) << result.process << std::setw(10) << result.pid << std::setw(10) << threads
+            << std::setw(14) << std::fixed << std::setprecision(1) << result.bufferSize / (1024.0 * 1024.0)
+            << result.status << "\n";
+    }
+
+    output->flags(flags);
+    output->precision(precision);
+
+    *output << std::flush;
+}
+
+// Bytes lidos e escritos pelos kernels da fase principal, 0 nos modos que nao medem o trafego
+double StressSession::phaseTraffic() const
+{
+    double traffic = 0;
+
+    switch (sessionConfig.mode)
+    {
+        case StressMode::Stress:
+            for (const ThreadResult& result : sessionResults.threadResults) traffic += result.bytesRead + result.bytesWritten;
+
+            // O EDAC so acompanhou esta execucao, nao o trecho antes do checkpoint
+            for (const ThreadCheckpoint& state : resumeState.threads) traffic -= state.bytesRead + state.bytesWritten;
+            break;
+
+        case StressMode::Replay:
+            traffic = sessionResults.replay.bytes;
+            break;
+
+        case StressMode::Scaling:
+            traffic = sessionResults.scaling.bytes;
+            break;
+
+        case StressMode::Mixed:
+            traffic = sessionResults.mixed.bytes;
+            break;
+
+        case StressMode::Pressure:
+            // No modo aleatorio cada operacao le e escreve um byte
+            traffic = sessionResults.pressure.achieved * sessionResults.elapsedSeconds * (sessionResults.pressure.bandwidthMode ? 1 : 2);
+            break;
+
+        default:
+            break;
+    }
+
+    return traffic;
+}
+
+// Erros corrigidos e nao corrigidos do EDAC em cada fase, comparados com o trafego que a fase gerou.
+// Um DIMM se degradando aparece como CE/GB subindo com a carga muito antes de um erro nao corrigido.
+void StressSession::reportEdac()
+{
+    if (!output || sessionResults.edacPhases.empty()) return;
+
+    if (!sessionResults.edacPhases.front().available)
+    {
+        *output << "\nEDAC: indisponível (driver não carregado ou sem /sys/devices/system/edac)" << std::endl;
+        return;
+    }
+
+    std::ios::fmtflags flags = output->flags();
+    std::streamsize precision = output->precision();
+
+    *output << "\nFase            Duração (s)   Tráfego (GB)   GB/s      CE        UE        CE/GB" << std::endl;
+
+    for (const EdacPhase& phase : sessionResults.edacPhases)
+    {
+        *output << std::left << std::fixed << std::setprecision(2)
+            << std::setw(16) << phase.phase
+            << std::setw(14) << phase.seconds;
+
+        if (phase.trafficBytes > 0)
+        {
+            *output << std::setw(15) << phase.trafficBytes / 1e9 << std::setw(10) << phase.gbps();
+        } else {
+            *output << std::setw(15) << "-" << std::setw(10) << "-";
+        }
+
+        *output << std::setw(10) << phase.corrected << std::setw(10) << phase.uncorrected;
+
+        if (phase.trafficBytes > 0)
+        {
+            *output << std::setprecision(4) << phase.correctedPerGB();
+        } else {
+            *output << "-";
+        }
+
+        *output << std::endl;
+
+        for (const EdacSample& sample : phase.samples)
+        {
+            *output << "  " << std::setprecision(1) << sample.seconds << " s: " << sample.corrected << " CE, "
+                << sample.uncorrected << " UE acumulados" << std::endl;
+        }
+
+        for (const DimmCounters& dimm : phase.increased)
+        {
+            *output << "  " << (dimm.label.empty() ? dimm.name : dimm.label + " (" + dimm.name + ")")
+                << ": +" << dimm.corrected << " CE, +" << dimm.uncorrected << " UE" << std::endl;
+        }
+    }
+
+    output->flags(flags);
+    output->precision(precision);
+}
+
+// Relatorio das falhas com endereco fisico e DIMM, o que o fornecedor pede para trocar o modulo
+void StressSession::reportFaults()
+{
+    if (!output) return;
+
+    for (const DimmCounters& dimm : sessionResults.edacIncreased)
+    {
+        *output << "EDAC: " << (dimm.label.empty() ? dimm.name : dimm.label + " (" + dimm.name + ")")
+            << " registrou " << dimm.corrected << " erros corrigidos e " << dimm.uncorrected << " não corrigidos" << std::endl;
+    }
+
+    if (sessionResults.faults.empty()) return;
+
+    *output << "\nFalhas detectadas (até " << maxFaultsPerThread << " por thread):" << std::endl;
+
+    std::ios::fmtflags flags = output->flags();
+
+    for (const FaultRecord& fault : sessionResults.faults)
+    {
+        *output << std::dec << "  " << std::fixed << std::setprecision(3) << fault.seconds << " s, thread " << fault.thread
+            << ", posição " << fault.offset
+            << std::hex << ", virtual 0x" << fault.virtualAddress;
+
+        if (fault.physicalAddress != 0)
+        {
+            *output << ", físico 0x" << fault.physicalAddress;
+        } else {
+            *output << ", físico indisponível (requer CAP_SYS_ADMIN)";
+        }
+
+        if (!fault.dimmLabel.empty()) *output << ", DIMM " << fault.dimmLabel;
+
+        // Com semente a falha pode ser reproduzida pelo modo replay a partir da sequencia
+        if (sessionConfig.seed != 0 && sessionConfig.mode != StressMode::Mixed) *output << std::dec << ", sequência " << fault.sequence;
+
+        *output << std::endl;
+    }
+
+    if (!sessionResults.badPages.empty()) *output << "\nPáginas isoladas:" << std::endl;
+
+    for (const BadPage& page : sessionResults.badPages)
+    {
+        *output << std::dec << "  " << std::fixed << std::setprecision(3) << page.seconds << " s, thread " << page.thread
+            << std::hex << ", virtual 0x" << page.virtualAddress;
+
+        if (page.physicalAddress != 0) *output << ", físico 0x" << page.physicalAddress;
+
+        *output << ", " << page.action << std::endl;
+    }
+
+    output->flags(flags);
+}
+
+// Resultado de cada thread e a dispersao da vazao entre threads e entre nucleos
+void StressSession::collectThreadResults(const std::vector<ThreadStats>& stats, double seconds)
+{
+    const CpuTopology& topology = cpuTopology();
+    std::vector<double> invertThroughput;
+    std::vector<double> swapThroughput;
+
+    sessionResults.threadResults.clear();
+
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        ThreadResult result;
+        result.thread = static_cast<int>(i);
+        result.operations = stats[i].operations.load(std::memory_order_relaxed);
+        result.bytesRead = stats[i].bytesRead.load(std::memory_order_relaxed);
+        result.bytesWritten = stats[i].bytesWritten.load(std::memory_order_relaxed);
+        result.errors = stats[i].errors.load(std::memory_order_relaxed);
+        result.maxLatencyNanos = stats[i].maxLatencyNanos.load(std::memory_order_relaxed);
+        result.opsPerSecond = seconds > 0 ? result.operations / seconds : 0;
+        result.swap = i % 2 != 0;
+
+        if (!sessionResults.placement.empty())
+        {
+            result.cpu = sessionResults.placement[i % sessionResults.placement.size()];
+
+            for (const LogicalCpu& cpu : topology.cpus)
+            {
+                if (cpu.id == result.cpu) result.core = cpu.core;
+            }
+        }
+
+        (result.swap ? swapThroughput : invertThroughput).push_back(result.opsPerSecond);
+        sessionResults.threadResults.push_back(result);
+    }
+
+    sessionResults.invertThreadSpread = summarizeThroughput(invertThroughput);
+    sessionResults.swapThreadSpread = summarizeThroughput(swapThroughput);
+    sessionResults.invertCoreSpread = summarizeThroughput(throughputPerCore(sessionResults.threadResults, false));
+    sessionResults.swapCoreSpread = summarizeThroughput(throughputPerCore(sessionResults.threadResults, true));
+
+    reportThreadResults();
+}
+
+void StressSession::reportThreadResults()
+{
+    if (!output) return;
+
+    *output << "\n\nThread  CPU    Núcleo  Ops/s         Lido (MiB)    Escrito (MiB) Erros     Latência máx. (ns)" << std::endl;
+
+    for (const ThreadResult& result : sessionResults.threadResults)
+    {
+        *output << std::left
+            << std::setw(8) << result.thread
+            << std::setw(7) << (result.cpu >= 0 ? std::to_string(result.cpu) : "-")
+            << std::setw(8) << (result.core >= 0 ? std::to_string(result.core) : "-")
+            << std::setw(14) << static_cast<long long>(result.opsPerSecond)
+            << std::setw(14) << result.bytesRead / (1024 * 1024)
+            << std::setw(14) << result.bytesWritten / (1024 * 1024)
+            << std::setw(10) << result.errors
+            << result.maxLatencyNanos << std::right << std::endl;
+    }
+
+    // Tipos sem threads (uma thread so nao tem troca) ficam de fora
+    auto reportSpread = [&](const char * label, const ThroughputSpread& spread) {
+        if (spread.count == 0) return;
+
+        *output << "Vazão por " << label << " (ops/s): mín " << static_cast<long long>(spread.min)
+            << ", máx " << static_cast<long long>(spread.max)
+            << ", média " << static_cast<long long>(spread.mean)
+            << ", desvio padrão " << static_cast<long long>(spread.stddev)
+            << " (" << (spread.mean > 0 ? 100.0 * spread.stddev / spread.mean : 0) << "%)" << std::endl;
+    };
+
+    *output << std::endl;
+    reportSpread("thread de inversão", sessionResults.invertThreadSpread);
+    reportSpread("thread de troca", sessionResults.swapThreadSpread);
+
+    if (sessionResults.invertCoreSpread.count > 0 || sessionResults.swapCoreSpread.count > 0)
+    {
+        reportSpread("núcleo, inversão", sessionResults.invertCoreSpread);
+        reportSpread("núcleo, troca", sessionResults.swapCoreSpread);
+    } else {
+        *output << "Vazão por núcleo: disponível apenas com as threads presas (--placement)" << std::endl;
+    }
+}
+
+// Resumo da telemetria do estresse: uma frequencia minima baixa, temperaturas altas ou a banda caindo
+// ao longo da execucao indicam throttling da CPU ou da memoria sob a carga
+void StressSession::reportTelemetry()
+{
+    const TelemetrySummary& summary = sessionResults.telemetrySummary;
+
+    if (!output || summary.samples == 0) return;
+
+    std::ios::fmtflags flags = output->flags();
+    std::streamsize precision = output->precision();
+
+    *output << std::fixed << std::setprecision(0) << "\nTelemetria (" << summary.samples << " leituras):" << std::endl;
+
+    if (summary.meanCpuMhz > 0)
+    {
+        *output << "  Frequência da CPU: média " << summary.meanCpuMhz << " MHz, mínima " << summary.minCpuMhz << " MHz" << std::endl;
+    }
+
+    if (summary.maxPackageCelsius > 0) *output << "  Temperatura máx. do pacote: " << summary.maxPackageCelsius << " °C" << std::endl;
+    if (summary.maxDramCelsius > 0) *output << "  Temperatura máx. dos DIMMs: " << summary.maxDramCelsius << " °C" << std::endl;
+
+    *output << std::setprecision(1);
+
+    if (summary.meanPackageWatts > 0) *output << "  Potência média do pacote: " << summary.meanPackageWatts << " W" << std::endl;
+    if (summary.meanDramWatts > 0) *output << "  Potência média da DRAM: " << summary.meanDramWatts << " W" << std::endl;
+
+    *output << std::setprecision(2) << "  Banda média: " << summary.meanGbps << " GB/s";
+    if (summary.gbpsPerWatt > 0) *output << " (" << summary.gbpsPerWatt << " GB/s por W)";
+    *output << std::endl;
+
+    *output << std::setprecision(1) << "  Queda da banda entre a melhor leitura e a última: " << summary.throughputDropPercent << "%" << std::endl;
+
+    output->flags(flags);
+    output->precision(precision);
+}
+
+} // namespace memstress
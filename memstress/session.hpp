@@ -0,0 +1,260 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "memstress/buffer.hpp"
+#include "memstress/checkpoint.hpp"
+#include "memstress/churn.hpp"
+#include "memstress/edac.hpp"
+#include "memstress/interleave.hpp"
+#include "memstress/kernels.hpp"
+#include "memstress/mixed.hpp"
+#include "memstress/pressure.hpp"
+#include "memstress/quarantine.hpp"
+#include "memstress/ramp.hpp"
+#include "memstress/scaling.hpp"
+#include "memstress/stats.hpp"
+#include "memstress/telemetry.hpp"
+#include "memstress/topology.hpp"
+
+namespace memstress
+{
+
+// O que a sessao executa depois de preencher o buffer
+enum class StressMode
+{
+    Stress,     // inverte e troca posicoes aleatorias conferindo cada escrita
+    Ramp,       // curva de banda e latencia por tamanho do conjunto de trabalho
+    Pressure,   // banda ou operacoes/s alvo em ritmo controlado
+    Interleave, // bits de canal, banco e linha e a banda de cada canal
+    Churn,      // aloca e libera blocos continuamente, sem o buffer principal
+    Replay,     // reexecuta a sequencia de operacoes de uma thread de um estresse com semente
+    Scaling,    // banda e operacoes aleatorias por quantidade de threads, por no NUMA
+    Mixed       // leituras e escritas conferidas na proporcao, padrao e largura pedidos
+};
+
+struct StressConfig
+{
+    // Quantidade de threads, 0 para derivar da topologia conforme a politica de posicionamento
+    int threads = 0;
+    PlacementPolicy placement = PlacementPolicy::None;
+
+    // Porcentagem da memoria livre usada pelo buffer, ignorada se sizeBytes > 0
+    int percentLimit = 60;
+    long long sizeBytes = 0;
+
+    std::chrono::seconds duration{60};
+
+    bool lockMemory = false;
+    PrefaultMode prefault = PrefaultMode::None;
+
+    // Origem da memoria do buffer e o arquivo dos backends File e Dax. No multiprocesso cada processo usa
+    // o arquivo com o proprio indice no final do nome.
+    BufferBackend backend = BufferBackend::Anonymous;
+    std::string backendPath;
+
+    // Pagina com falha no estresse: continua sorteada ou eh isolada, opcionalmente aposentando o frame
+    QuarantineMode quarantine = QuarantineMode::None;
+
+    // Conjunto de instrucoes maximo dos kernels de blocos
+    KernelIsa kernelIsa = KernelIsa::Auto;
+
+    StressMode mode = StressMode::Stress;
+
+    // Semente da execucao, cada thread usa uma sequencia derivada dela e do seu indice; 0 sorteia
+    uint64_t seed = 0;
+
+    // Modo replay: thread do estresse original, posicao do gerador onde comecar e operacoes da janela,
+    // repetida ate o prazo; janela 0 segue a sequencia sem repetir. Tamanho do buffer e threads precisam
+    // ser os da execucao original para a thread ter a mesma faixa.
+    int replayThread = 0;
+    uint64_t replayFrom = 0;
+    long long replayCount = 0;
+
+    // Estresse padrao (modo Stress) em varios processos, cada um com a sua fatia do buffer e das threads;
+    // 0 ou 1 roda no proprio processo. Os outros modos rodam sempre no proprio processo, o mem-stress
+    // recusa o --processes junto com eles. Contorna os limites por processo (RLIMIT_AS, heuristica de
+    // overcommit) e isola a queda de um processo (SIGBUS de uma pagina envenenada) dos demais.
+    int processes = 0;
+
+    // Intervalo dos relatorios periodicos
+    int reportSeconds = 1;
+
+    // Exportacao das metricas do estresse a cada relatorio: arquivo para o textfile collector do
+    // node_exporter e/ou porta do endpoint HTTP, vazio e 0 desativam
+    std::string metricsFile;
+    int metricsPort = 0;
+
+    // Arquivo de checkpoint do estresse, gravado a cada checkpointSeconds e ao parar; vazio desativa.
+    // Ao terminar o prazo o arquivo eh removido, so uma execucao interrompida deixa checkpoint.
+    std::string checkpointFile;
+    int checkpointSeconds = 60;
+
+    // Trace das operacoes do estresse e do replay em formato binario compacto, vazio desativa. A gravacao
+    // para ao atingir traceMaxBytes (0 sem limite), os eventos seguintes so sao contados.
+    std::string traceFile;
+    long long traceMaxBytes = 1024LL * 1024 * 1024;
+
+    // Modo pressao, apenas um dos alvos deve ser maior que zero
+    double targetGbps = 0;
+    double targetOps = 0;
+
+    // Modo churn, taxa zero para sem limite
+    ChurnMethod churnMethod = ChurnMethod::Malloc;
+    double churnRate = 0;
+    long long churnMaxChunkSize = 16 * 1024 * 1024;
+
+    // Varredura de escalabilidade, kernels de blocos medidos em cada passo
+    std::vector<std::string> scalingKernels = scalingKernelNames();
+
+    // Modo misto, proporcao de leituras, padrao de acesso e largura
+    MixedWorkload mixed;
+};
+
+// Processo do estresse multiprocesso: as threads globais que ele rodou, a fatia do buffer e como terminou
+struct ProcessResult
+{
+    int process = 0;
+    int pid = 0;
+    int firstThread = 0;
+    int threads = 0;
+    long long bufferSize = 0;
+
+    std::string status;
+    bool failed = false;
+};
+
+// Resultado do modo replay
+struct ReplaySummary
+{
+    int thread = 0;
+    Range range{0, 0};
+    bool swap = false;
+
+    long long operations = 0;
+    long long errors = 0;
+    long long passes = 0;
+    long long bytes = 0;
+};
+
+struct StressResults
+{
+    // Threads usadas e a CPU de cada uma, vazio se nao foram presas
+    int threads = 0;
+    std::vector<int> placement;
+
+    long long bufferSize = 0;
+
+    bool locked = false;
+    std::string lockError;
+
+    // Motivo de o buffer nao ter sido mapeado no backend pedido, vazio se a execucao chegou ao estresse
+    std::string bufferError;
+
+    double allocationSeconds = 0;
+    double fillSeconds = 0;
+
+    // Porcentagem do buffer na RAM antes e depois do estresse, -1 se nao for possivel medir
+    double residencyBefore = -1;
+    double residencyAfter = -1;
+
+    // Duracao, operacoes e erros detectados na fase de estresse
+    double elapsedSeconds = 0;
+    long long operations = 0;
+    long long errors = 0;
+
+    // Contadores de cada thread do estresse e a dispersao da vazao entre threads e entre nucleos,
+    // separada entre as threads de inversao e as de troca. Um desequilibrio dentro do mesmo tipo costuma
+    // apontar um nucleo ruim ou um canal de memoria degradado.
+    std::vector<ThreadResult> threadResults;
+    ThroughputSpread invertThreadSpread;
+    ThroughputSpread swapThreadSpread;
+    ThroughputSpread invertCoreSpread;
+    ThroughputSpread swapCoreSpread;
+
+    // Frequencia, temperaturas e potencia lidas a cada relatorio do estresse junto com a vazao do intervalo
+    std::vector<TelemetrySample> telemetry;
+    TelemetrySummary telemetrySummary;
+
+    // Falhas com endereco virtual, fisico e DIMM, e os DIMMs cujos contadores do EDAC subiram na execucao
+    std::vector<FaultRecord> faults;
+    std::vector<DimmCounters> edacIncreased;
+
+    // Erros do EDAC em cada fase (preenchimento e o modo executado) com o trafego gerado
+    std::vector<EdacPhase> edacPhases;
+
+    // Paginas isoladas pelo modo de quarentena, na ordem em que cada thread as encontrou
+    std::vector<BadPage> badPages;
+
+    std::vector<RampStep> rampSteps;
+    PressureSummary pressure;
+    InterleaveSummary interleave;
+    ScalingSummary scaling;
+    MixedSummary mixed;
+    ChurnSummary churn;
+    ReplaySummary replay;
+
+    // Processos do estresse multiprocesso, vazio no estresse em um processo so
+    std::vector<ProcessResult> processes;
+};
+
+// Memoria compartilhada entre o pai e os processos do estresse multiprocesso, definida no session.cpp
+struct ProcessBoard;
+
+// Sessao de estresse: dona do buffer, das threads, da configuracao e dos resultados.
+// Permite rodar verificacoes de memoria dentro de outro processo sem interpretar a saida do mem-stress.
+class StressSession
+{
+public:
+    explicit StressSession(StressConfig config);
+
+    // Progresso da execucao (etapas, tabelas e relatorios periodicos), nulo para rodar em silencio
+    void setOutput(std::ostream * output);
+
+    // Aloca, preenche e executa o modo configurado. Lanca std::bad_alloc se o buffer nao puder ser alocado.
+    const StressResults& run();
+
+    // Pede para a execucao terminar antes do prazo, pode ser chamado de outra thread
+    void stop();
+
+    // Continua um estresse interrompido: o run() aloca e preenche um buffer do mesmo tamanho, com as mesmas
+    // threads, e segue pelo tempo que faltava com os contadores, falhas e geradores do checkpoint.
+    // Retorna a mensagem de erro, vazia se o checkpoint pode ser usado.
+    std::string resumeFrom(const StressCheckpoint& checkpoint);
+
+    const StressConfig& config() const { return sessionConfig; }
+    const StressResults& results() const { return sessionResults; }
+
+private:
+    void placeThreads();
+    bool allocateBuffer();
+    void reportResidency(const char * phase, double residency);
+    void runStress(const RunDeadline& deadline);
+    void runReplay(const RunDeadline& deadline);
+    void runProcesses();
+    int runWorkerProcess(int process, ProcessBoard& board);
+    void reportProcesses();
+    void collectThreadResults(const std::vector<ThreadStats>& stats, double seconds);
+    void reportThreadResults();
+    void reportTelemetry();
+    void reportFaults();
+    void reportEdac();
+    double phaseTraffic() const;
+
+    StressConfig sessionConfig;
+    StressResults sessionResults;
+    std::ostream * output;
+
+    std::unique_ptr<Buffer> buffer;
+    std::atomic<bool> stopRequested;
+
+    // Estado de onde o estresse continua, sem threads quando a execucao comeca do zero
+    StressCheckpoint resumeState;
+};
+
+} // namespace memstress
@@ -0,0 +1,44 @@
+#include "memstress/stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace memstress
+{
+
+ThroughputSpread summarizeThroughput(const std::vector<double>& values)
+{
+    ThroughputSpread spread;
+
+    if (values.empty()) return spread;
+
+    spread.count = static_cast<int>(values.size());
+    spread.min = *std::min_element(values.begin(), values.end());
+    spread.max = *std::max_element(values.begin(), values.end());
+
+    for (double value : values) spread.mean += value;
+    spread.mean /= values.size();
+
+    for (double value : values) spread.stddev += (value - spread.mean) * (value - spread.mean);
+    spread.stddev = std::sqrt(spread.stddev / values.size());
+
+    return spread;
+}
+
+std::vector<double> throughputPerCore(const std::vector<ThreadResult>& threads, bool swap)
+{
+    std::map<int, double> cores;
+
+    for (const ThreadResult& thread : threads)
+    {
+        if (thread.core >= 0 && thread.swap == swap) cores[thread.core] += thread.opsPerSecond;
+    }
+
+    std::vector<double> values;
+    for (const auto& core : cores) values.push_back(core.second);
+
+    return values;
+}
+
+} // namespace memstress
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace memstress
+{
+
+// Limites superiores em ns das faixas do histograma de latencia, a ultima faixa recebe o resto (+Inf)
+const long long latencyBucketBounds[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 1000000};
+const int latencyBucketCount = sizeof(latencyBucketBounds) / sizeof(latencyBucketBounds[0]) + 1;
+
+// Contadores de uma thread de estresse. Cada bloco ocupa linhas de cache proprias, assim as threads
+// nao disputam a mesma linha (false sharing) e o relatorio le tudo com atomics relaxados.
+struct alignas(64) ThreadStats
+{
+    std::atomic<long long> operations{0};
+    std::atomic<long long> bytesRead{0};
+    std::atomic<long long> bytesWritten{0};
+    std::atomic<long long> errors{0};
+    std::atomic<long long> maxLatencyNanos{0};
+    std::atomic<long long> quarantinedPages{0};
+
+    // Histograma das latencias amostradas, nao cumulativo, e a soma delas
+    std::atomic<long long> latencyBuckets[latencyBucketCount] = {};
+    std::atomic<long long> latencySumNanos{0};
+
+    // So a thread dona escreve no bloco, entao load e store relaxados bastam e evitam o lock do fetch_add
+    static void add(std::atomic<long long>& counter, long long value)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    void recordLatency(long long nanos)
+    {
+        if (nanos > maxLatencyNanos.load(std::memory_order_relaxed)) maxLatencyNanos.store(nanos, std::memory_order_relaxed);
+
+        int bucket = 0;
+        while (bucket < latencyBucketCount - 1 && nanos > latencyBucketBounds[bucket]) bucket++;
+
+        add(latencyBuckets[bucket], 1);
+        add(latencySumNanos, nanos);
+    }
+};
+
+// Resultado final de uma thread, cpu e core valem -1 quando a thread nao foi presa
+struct ThreadResult
+{
+    int thread = 0;
+    int cpu = -1;
+    int core = -1;
+
+    long long operations = 0;
+    long long bytesRead = 0;
+    long long bytesWritten = 0;
+    long long errors = 0;
+    long long maxLatencyNanos = 0;
+
+    double opsPerSecond = 0;
+
+    // Thread de troca (indice impar), as pares invertem. Uma operacao de cada tipo custa diferente, entao
+    // a vazao so eh comparavel entre threads do mesmo tipo.
+    bool swap = false;
+};
+
+// Falha detectada por uma thread de estresse
+struct FaultRecord
+{
+    int thread = 0;
+    long long offset = 0;
+    uintptr_t virtualAddress = 0;
+
+    // 0 se o pagemap nao expuser o frame (sem CAP_SYS_ADMIN)
+    unsigned long long physicalAddress = 0;
+
+    // Segundos desde o inicio do estresse
+    double seconds = 0;
+
+    // Posicao do gerador da thread antes da operacao que falhou, o ponto de partida do --replay-from
+    unsigned long long sequence = 0;
+
+    // Rotulo do DIMM apontado pelo EDAC, vazio se nao for possivel apontar um so
+    std::string dimmLabel;
+};
+
+// Dispersao de uma vazao entre threads ou nucleos
+struct ThroughputSpread
+{
+    int count = 0;
+    double min = 0;
+    double max = 0;
+    double mean = 0;
+    double stddev = 0;
+};
+
+ThroughputSpread summarizeThroughput(const std::vector<double>& values);
+
+// Vazao somada por nucleo fisico, apenas das threads presas e do tipo pedido (troca ou inversao)
+std::vector<double> throughputPerCore(const std::vector<ThreadResult>& threads, bool swap);
+
+} // namespace memstress
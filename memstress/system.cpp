@@ -0,0 +1,152 @@
+#include "memstress/system.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include "memstress/format.hpp"
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+#ifdef __linux__
+    #include <dirent.h>
+    #include <fcntl.h>
+    #include <sys/resource.h>
+    #include <sys/sysinfo.h>
+    #include <unistd.h>
+#endif
+
+namespace memstress
+{
+
+long long getTotalAvailableVirtualMemory()
+{
+    #ifdef __linux__
+        // cria uma variavel do tipo sysinfo
+        struct sysinfo memInfo;
+
+        // popula a veriavel com os dados do sistema
+        sysinfo(&memInfo);
+
+        // inicializa com o total de memoria disponivel
+        long long totalMem = memInfo.freeram + memInfo.freeswap;
+        totalMem *= memInfo.mem_unit; // converte para bytes
+
+        return totalMem;
+    #endif
+
+    #ifdef _WIN32
+        MEMORYSTATUSEX status;
+        status.dwLength = sizeof(status);
+        GlobalMemoryStatusEx(&status);
+        return status.ullAvailPageFile;
+    #endif
+}
+
+long long calculateBufferSize(int percentLimit)
+{
+    long long totalAvailablePhysicalMem = getTotalAvailableVirtualMemory();
+    return (totalAvailablePhysicalMem * percentLimit) / 100;
+}
+
+long long getPageSize()
+{
+    #ifdef __linux__
+        return sysconf(_SC_PAGESIZE);
+    #else
+        return 4096;
+    #endif
+}
+
+long long readResidentSetSize()
+{
+    #ifdef __linux__
+        std::ifstream statm("/proc/self/statm");
+        long long totalPages = 0, residentPages = 0;
+
+        if (!(statm >> totalPages >> residentPages)) return 0;
+
+        return residentPages * getPageSize();
+    #else
+        return 0;
+    #endif
+}
+
+long long readMinorPageFaults()
+{
+    #ifdef __linux__
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_minflt;
+    #else
+        return 0;
+    #endif
+}
+
+std::string describeMemlockLimit()
+{
+    #ifdef __linux__
+        struct rlimit limit;
+
+        if (getrlimit(RLIMIT_MEMLOCK, &limit) != 0) return "";
+
+        return (limit.rlim_cur == RLIM_INFINITY ? "ilimitado" : formatMiB(limit.rlim_cur)) + " / "
+            + (limit.rlim_max == RLIM_INFINITY ? "ilimitado" : formatMiB(limit.rlim_max));
+    #else
+        return "";
+    #endif
+}
+
+unsigned long long physicalAddressOf(const volatile void * address)
+{
+    #ifdef __linux__
+        const unsigned long long frameMask = (1ULL << 55) - 1;
+        const unsigned long long presentBit = 1ULL << 63;
+        const unsigned long long pageSize = getPageSize();
+
+        unsigned long long virtualAddress = reinterpret_cast<uintptr_t>(address);
+        uint64_t entry = 0;
+
+        int file = open("/proc/self/pagemap", O_RDONLY);
+
+        if (file < 0) return 0;
+
+        ssize_t readBytes = pread(file, &entry, sizeof(entry), (virtualAddress / pageSize) * sizeof(entry));
+        close(file);
+
+        if (readBytes != sizeof(entry) || !(entry & presentBit) || (entry & frameMask) == 0) return 0;
+
+        return (entry & frameMask) * pageSize + virtualAddress % pageSize;
+    #else
+        (void)address;
+        return 0;
+    #endif
+}
+
+std::vector<std::string> listEntries(const std::string& path, const std::string& prefix)
+{
+    std::vector<std::string> entries;
+
+    #ifdef __linux__
+        DIR * directory = opendir(path.c_str());
+
+        if (!directory) return entries;
+
+        while (dirent * entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+            if (name.compare(0, prefix.size(), prefix) == 0) entries.push_back(name);
+        }
+
+        closedir(directory);
+    #else
+        (void)path;
+        (void)prefix;
+    #endif
+
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+} // namespace memstress
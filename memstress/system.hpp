@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace memstress
+{
+
+// Memoria virtual livre (RAM + swap) em bytes
+long long getTotalAvailableVirtualMemory();
+
+// Tamanho do buffer para a porcentagem da memoria livre
+long long calculateBufferSize(int percentLimit);
+
+// Tamanho da pagina do sistema
+long long getPageSize();
+
+// Memoria residente do processo (RSS) em bytes
+long long readResidentSetSize();
+
+// Quantidade de page faults (sem I/O) do processo ate agora
+long long readMinorPageFaults();
+
+// Limite RLIMIT_MEMLOCK formatado como "soft / hard", vazio se nao disponivel
+std::string describeMemlockLimit();
+
+// Endereco fisico do byte pelo /proc/self/pagemap, 0 se a pagina nao estiver na RAM ou o processo
+// nao tiver CAP_SYS_ADMIN (sem privilegio o kernel esconde os frames)
+unsigned long long physicalAddressOf(const volatile void * address);
+
+// Entradas do diretorio que comecam com o prefixo, em ordem, vazio se o diretorio nao existir
+std::vector<std::string> listEntries(const std::string& path, const std::string& prefix);
+
+} // namespace memstress
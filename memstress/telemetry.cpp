@@ -0,0 +1,259 @@
+#include "memstress/telemetry.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "memstress/system.hpp"
+
+namespace memstress
+{
+
+namespace
+{
+
+const std::string cpuSysfsPath = "/sys/devices/system/cpu/";
+const std::string hwmonPath = "/sys/class/hwmon/";
+const std::string powercapPath = "/sys/class/powercap/";
+
+// Le a primeira linha de um arquivo do sysfs, vazio se nao existir
+std::string readSysfsLine(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string line;
+
+    std::getline(file, line);
+    return line;
+}
+
+// Le um numero de um arquivo do sysfs, false se nao existir ou nao puder ser lido
+bool readSysfsNumber(const std::string& path, unsigned long long& value)
+{
+    std::ifstream file(path);
+    return static_cast<bool>(file >> value);
+}
+
+// Sensores tempN_input do hwmon; com prefixo, so os cujo tempN_label comeca com ele
+std::vector<std::string> temperatureInputs(const std::string& sensorPath, const std::string& labelPrefix)
+{
+    std::vector<std::string> inputs;
+
+    for (const std::string& entry : listEntries(sensorPath, "temp"))
+    {
+        const std::string suffix = "_input";
+        if (entry.size() <= suffix.size() || entry.compare(entry.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
+
+        std::string sensor = entry.substr(0, entry.size() - suffix.size());
+        std::string label = readSysfsLine(sensorPath + sensor + "_label");
+
+        if (labelPrefix.empty() || label.compare(0, labelPrefix.size(), labelPrefix) == 0) inputs.push_back(sensorPath + entry);
+    }
+
+    return inputs;
+}
+
+// Maior temperatura entre os sensores em graus Celsius, os arquivos estao em milesimos de grau
+double maxTemperature(const std::vector<std::string>& files)
+{
+    double celsius = 0;
+
+    for (const std::string& file : files)
+    {
+        unsigned long long milli = 0;
+        if (readSysfsNumber(file, milli)) celsius = std::max(celsius, milli / 1000.0);
+    }
+
+    return celsius;
+}
+
+} // namespace
+
+TelemetryReader::TelemetryReader()
+    : lastSample(std::chrono::steady_clock::now())
+{
+    for (const std::string& cpu : listEntries(cpuSysfsPath, "cpu"))
+    {
+        if (cpu.size() <= 3 || !std::isdigit(static_cast<unsigned char>(cpu[3]))) continue;
+
+        std::string path = cpuSysfsPath + cpu + "/cpufreq/scaling_cur_freq";
+        unsigned long long value = 0;
+
+        if (readSysfsNumber(path, value)) frequencyFiles.push_back(path);
+    }
+
+    for (const std::string& monitor : listEntries(hwmonPath, "hwmon"))
+    {
+        std::string sensorPath = hwmonPath + monitor + "/";
+        std::string name = readSysfsLine(sensorPath + "name");
+
+        // Intel expoe "Package id N" no coretemp, AMD o Tctl no k10temp; jc42 (DDR4) e spd5118 (DDR5)
+        // sao os sensores nos proprios DIMMs
+        std::vector<std::string> inputs;
+
+        if (name == "coretemp") inputs = temperatureInputs(sensorPath, "Package");
+        if (name == "k10temp") inputs = temperatureInputs(sensorPath, "Tctl");
+
+        packageTemperatureFiles.insert(packageTemperatureFiles.end(), inputs.begin(), inputs.end());
+
+        if (name == "jc42" || name == "spd5118")
+        {
+            inputs = temperatureInputs(sensorPath, "");
+            dramTemperatureFiles.insert(dramTemperatureFiles.end(), inputs.begin(), inputs.end());
+        }
+    }
+
+    // Zonas "package-N" e subzonas "dram"; desde o 5.10 o energy_uj so eh legivel pelo root
+    for (const std::string& zone : listEntries(powercapPath, "intel-rapl:"))
+    {
+        std::string zonePath = powercapPath + zone + "/";
+        std::string name = readSysfsLine(zonePath + "name");
+
+        if (name != "dram" && name.compare(0, 8, "package-") != 0) continue;
+
+        EnergyCounter counter;
+        counter.path = zonePath + "energy_uj";
+        counter.dram = name == "dram";
+
+        if (!readSysfsNumber(counter.path, counter.last)) continue;
+        readSysfsNumber(zonePath + "max_energy_range_uj", counter.maxRange);
+
+        energyCounters.push_back(counter);
+    }
+}
+
+bool TelemetryReader::available() const
+{
+    return !frequencyFiles.empty() || !packageTemperatureFiles.empty() || !dramTemperatureFiles.empty() || !energyCounters.empty();
+}
+
+TelemetrySample TelemetryReader::sample()
+{
+    TelemetrySample sample;
+
+    auto now = std::chrono::steady_clock::now();
+    double interval = std::chrono::duration<double>(now - lastSample).count();
+    lastSample = now;
+
+    for (const std::string& file : frequencyFiles)
+    {
+        unsigned long long khz = 0;
+        if (!readSysfsNumber(file, khz)) continue;
+
+        double mhz = khz / 1000.0;
+        sample.minCpuMhz = sample.minCpuMhz > 0 ? std::min(sample.minCpuMhz, mhz) : mhz;
+        sample.cpuMhz += mhz / frequencyFiles.size();
+    }
+
+    sample.packageCelsius = maxTemperature(packageTemperatureFiles);
+    sample.dramCelsius = maxTemperature(dramTemperatureFiles);
+
+    for (EnergyCounter& counter : energyCounters)
+    {
+        unsigned long long energy = 0;
+        if (!readSysfsNumber(counter.path, energy)) continue;
+
+        // O contador volta a zero ao passar de max_energy_range_uj
+        unsigned long long consumed = energy >= counter.last ? energy - counter.last : energy + counter.maxRange - counter.last;
+        counter.last = energy;
+
+        double watts = interval > 0 ? consumed / 1e6 / interval : 0;
+        (counter.dram ? sample.dramWatts : sample.packageWatts) += watts;
+    }
+
+    return sample;
+}
+
+std::string describeTelemetry(const TelemetrySample& sample)
+{
+    std::vector<std::string> fields;
+    std::ostringstream field;
+
+    auto add = [&]() {
+        fields.push_back(field.str());
+        field.str("");
+    };
+
+    field << std::fixed << std::setprecision(0);
+
+    if (sample.cpuMhz > 0)
+    {
+        field << sample.cpuMhz << " MHz";
+        add();
+    }
+
+    if (sample.packageCelsius > 0)
+    {
+        field << "pacote " << sample.packageCelsius << " °C";
+        add();
+    }
+
+    if (sample.dramCelsius > 0)
+    {
+        field << "DIMM " << sample.dramCelsius << " °C";
+        add();
+    }
+
+    field << std::setprecision(1);
+
+    if (sample.packageWatts > 0)
+    {
+        field << "pacote " << sample.packageWatts << " W";
+        add();
+    }
+
+    if (sample.dramWatts > 0)
+    {
+        field << "DRAM " << sample.dramWatts << " W";
+        add();
+    }
+
+    if (sample.gbpsPerWatt() > 0)
+    {
+        field << std::setprecision(2) << sample.gbpsPerWatt() << " GB/s/W";
+        add();
+    }
+
+    std::string text;
+
+    for (const std::string& item : fields)
+    {
+        if (!text.empty()) text += ", ";
+        text += item;
+    }
+
+    return text;
+}
+
+TelemetrySummary summarizeTelemetry(const std::vector<TelemetrySample>& samples)
+{
+    TelemetrySummary summary;
+    summary.samples = static_cast<int>(samples.size());
+
+    if (samples.empty()) return summary;
+
+    double maxGbps = 0;
+
+    for (const TelemetrySample& sample : samples)
+    {
+        summary.meanCpuMhz += sample.cpuMhz / samples.size();
+        summary.meanPackageWatts += sample.packageWatts / samples.size();
+        summary.meanDramWatts += sample.dramWatts / samples.size();
+        summary.meanGbps += sample.gbps / samples.size();
+
+        if (sample.minCpuMhz > 0) summary.minCpuMhz = summary.minCpuMhz > 0 ? std::min(summary.minCpuMhz, sample.minCpuMhz) : sample.minCpuMhz;
+
+        summary.maxPackageCelsius = std::max(summary.maxPackageCelsius, sample.packageCelsius);
+        summary.maxDramCelsius = std::max(summary.maxDramCelsius, sample.dramCelsius);
+        maxGbps = std::max(maxGbps, sample.gbps);
+    }
+
+    double watts = summary.meanDramWatts > 0 ? summary.meanDramWatts : summary.meanPackageWatts;
+    if (watts > 0) summary.gbpsPerWatt = summary.meanGbps / watts;
+
+    if (maxGbps > 0) summary.throughputDropPercent = (maxGbps - samples.back().gbps) / maxGbps * 100;
+
+    return summary;
+}
+
+} // namespace memstress
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace memstress
+{
+
+// Leitura de frequencia, temperatura e energia em um intervalo do relatorio. Cada campo fica em 0
+// quando a fonte nao existe na maquina (VMs, drivers nao carregados, RAPL sem permissao).
+struct TelemetrySample
+{
+    double seconds = 0;
+
+    // Vazao da carga no intervalo, preenchida por quem gera a carga
+    double opsPerSecond = 0;
+    double gbps = 0;
+
+    // Media e menor frequencia atual das CPUs (cpufreq scaling_cur_freq)
+    double cpuMhz = 0;
+    double minCpuMhz = 0;
+
+    // Maior temperatura entre os pacotes (coretemp/k10temp) e entre os DIMMs (jc42/spd5118)
+    double packageCelsius = 0;
+    double dramCelsius = 0;
+
+    // Potencia media no intervalo pelos contadores de energia do RAPL
+    double packageWatts = 0;
+    double dramWatts = 0;
+
+    // Banda por watt da DRAM, ou do pacote quando nao ha dominio DRAM no RAPL
+    double gbpsPerWatt() const
+    {
+        double watts = dramWatts > 0 ? dramWatts : packageWatts;
+        return watts > 0 ? gbps / watts : 0;
+    }
+};
+
+// Descobre as fontes de telemetria uma vez e le todas a cada chamada de sample()
+class TelemetryReader
+{
+public:
+    TelemetryReader();
+
+    bool available() const;
+
+    // Le as fontes; a potencia eh a media desde a leitura anterior (ou desde a construcao)
+    TelemetrySample sample();
+
+private:
+    struct EnergyCounter
+    {
+        std::string path;
+        bool dram = false;
+        unsigned long long maxRange = 0;
+        unsigned long long last = 0;
+    };
+
+    std::vector<std::string> frequencyFiles;
+    std::vector<std::string> packageTemperatureFiles;
+    std::vector<std::string> dramTemperatureFiles;
+    std::vector<EnergyCounter> energyCounters;
+
+    std::chrono::time_point<std::chrono::steady_clock> lastSample;
+};
+
+// Campos disponiveis da leitura para a linha de progresso, ex. "2900 MHz, pacote 71 °C, DRAM 14.2 W"
+std::string describeTelemetry(const TelemetrySample& sample);
+
+// Resumo das leituras de uma fase: menor frequencia, maiores temperaturas e banda por watt media
+struct TelemetrySummary
+{
+    int samples = 0;
+    double meanCpuMhz = 0;
+    double minCpuMhz = 0;
+    double maxPackageCelsius = 0;
+    double maxDramCelsius = 0;
+    double meanPackageWatts = 0;
+    double meanDramWatts = 0;
+    double meanGbps = 0;
+    double gbpsPerWatt = 0;
+
+    // Queda da banda entre a melhor leitura e a ultima, em porcentagem; sinal de throttling sob carga
+    double throughputDropPercent = 0;
+};
+
+TelemetrySummary summarizeTelemetry(const std::vector<TelemetrySample>& samples);
+
+} // namespace memstress
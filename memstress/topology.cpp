@@ -0,0 +1,267 @@
+#include "memstress/topology.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+#ifdef __linux__
+    #include <sched.h>
+#endif
+
+namespace memstress
+{
+
+namespace
+{
+
+const std::string cpuSysfsPath = "/sys/devices/system/cpu/";
+const std::string nodeSysfsPath = "/sys/devices/system/node/";
+
+// Interpreta uma lista de CPUs do sysfs no formato "0-3,8,10-11"
+std::vector<int> parseCpuList(const std::string& text)
+{
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string item;
+
+    while (std::getline(stream, item, ','))
+    {
+        int first = 0;
+        int last = 0;
+        char separator = 0;
+        std::stringstream itemStream(item);
+
+        if (!(itemStream >> first)) continue;
+        last = (itemStream >> separator >> last) && separator == '-' ? last : first;
+
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+
+// Le a primeira linha de um arquivo do sysfs, vazio se nao existir
+std::string readSysfsLine(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string line;
+
+    std::getline(file, line);
+    return line;
+}
+
+// Primeira CPU de uma lista do sysfs, usada como chave do grupo, ou o valor padrao se nao existir
+int firstCpuOf(const std::string& path, int defaultValue)
+{
+    std::vector<int> cpus = parseCpuList(readSysfsLine(path));
+    return cpus.empty() ? defaultValue : cpus.front();
+}
+
+// CPUs que o processo pode usar: a afinidade atual, ou as CPUs online
+std::vector<int> allowedCpus()
+{
+    std::vector<int> cpus;
+
+    #ifdef __linux__
+        cpu_set_t set;
+
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+        {
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+            {
+                if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+            }
+        }
+    #endif
+
+    if (cpus.empty()) cpus = parseCpuList(readSysfsLine(cpuSysfsPath + "online"));
+
+    if (cpus.empty())
+    {
+        for (int cpu = 0; cpu < static_cast<int>(std::max(1u, std::thread::hardware_concurrency())); cpu++) cpus.push_back(cpu);
+    }
+
+    return cpus;
+}
+
+// Chave do dominio da ultima cache: a primeira CPU que compartilha a cache de maior nivel (exceto instrucoes)
+int lastLevelCacheKey(int cpu)
+{
+    int bestLevel = 0;
+    int key = -1;
+
+    for (int index = 0; ; index++)
+    {
+        std::string cachePath = cpuSysfsPath + "cpu" + std::to_string(cpu) + "/cache/index" + std::to_string(index) + "/";
+        std::string level = readSysfsLine(cachePath + "level");
+
+        if (level.empty()) break;
+        if (readSysfsLine(cachePath + "type") == "Instruction") continue;
+
+        if (std::stoi(level) > bestLevel)
+        {
+            bestLevel = std::stoi(level);
+            key = firstCpuOf(cachePath + "shared_cpu_list", cpu);
+        }
+    }
+
+    return key;
+}
+
+// No NUMA de cada CPU, tudo no no 0 se o sysfs nao tiver nos
+std::map<int, int> readCpuNodes()
+{
+    std::map<int, int> cpuNodes;
+
+    for (int node : parseCpuList(readSysfsLine(nodeSysfsPath + "online")))
+    {
+        for (int cpu : parseCpuList(readSysfsLine(nodeSysfsPath + "node" + std::to_string(node) + "/cpulist")))
+        {
+            cpuNodes[cpu] = node;
+        }
+    }
+
+    return cpuNodes;
+}
+
+// Troca as chaves (CPU ou no) por indices sequenciais na ordem em que aparecem
+int sequentialIndex(std::map<int, int>& indices, int key)
+{
+    auto inserted = indices.emplace(key, static_cast<int>(indices.size()));
+    return inserted.first->second;
+}
+
+CpuTopology detectTopology()
+{
+    CpuTopology topology;
+    std::map<int, int> cpuNodes = readCpuNodes();
+    std::map<int, int> coreIndices, llcIndices, nodeIndices;
+    std::map<int, int> siblingCounts;
+
+    for (int cpu : allowedCpus())
+    {
+        std::string topologyPath = cpuSysfsPath + "cpu" + std::to_string(cpu) + "/topology/";
+        int coreKey = firstCpuOf(topologyPath + "thread_siblings_list", cpu);
+        auto node = cpuNodes.find(cpu);
+
+        LogicalCpu logical;
+        logical.id = cpu;
+        logical.core = sequentialIndex(coreIndices, coreKey);
+        logical.llc = sequentialIndex(llcIndices, lastLevelCacheKey(cpu));
+        logical.node = sequentialIndex(nodeIndices, node == cpuNodes.end() ? 0 : node->second);
+        logical.sibling = siblingCounts[logical.core]++;
+
+        topology.cpus.push_back(logical);
+    }
+
+    topology.coreCount = static_cast<int>(coreIndices.size());
+    topology.llcCount = static_cast<int>(llcIndices.size());
+    topology.nodeCount = static_cast<int>(nodeIndices.size());
+
+    return topology;
+}
+
+// Posicao do nucleo dentro do seu dominio e do dominio dentro do seu no, usadas para espalhar as threads
+struct SpreadRanks
+{
+    int coreInLlc;
+    int llcInNode;
+};
+
+std::vector<SpreadRanks> spreadRanks(const CpuTopology& topology)
+{
+    std::map<int, std::map<int, int>> coresPerLlc, llcsPerNode;
+    std::vector<SpreadRanks> ranks;
+
+    for (const LogicalCpu& cpu : topology.cpus)
+    {
+        ranks.push_back({sequentialIndex(coresPerLlc[cpu.llc], cpu.core), sequentialIndex(llcsPerNode[cpu.node], cpu.llc)});
+    }
+
+    return ranks;
+}
+
+} // namespace
+
+const CpuTopology& cpuTopology()
+{
+    static const CpuTopology topology = detectTopology();
+    return topology;
+}
+
+std::vector<int> planPlacement(const CpuTopology& topology, PlacementPolicy policy, int threadCount)
+{
+    if (policy == PlacementPolicy::None || topology.cpus.empty() || threadCount <= 0) return {};
+
+    std::vector<SpreadRanks> ranks = spreadRanks(topology);
+    std::vector<std::tuple<int, int, int, int, int>> order;
+
+    for (size_t i = 0; i < topology.cpus.size(); i++)
+    {
+        const LogicalCpu& cpu = topology.cpus[i];
+        const SpreadRanks& rank = ranks[i];
+
+        // Cada politica eh uma ordenacao das CPUs, as que ficam de fora sao descartadas
+        switch (policy)
+        {
+            case PlacementPolicy::Core:
+                if (cpu.sibling == 0) order.emplace_back(rank.coreInLlc, rank.llcInNode, cpu.node, 0, cpu.id);
+                break;
+
+            case PlacementPolicy::Smt:
+                order.emplace_back(rank.coreInLlc, rank.llcInNode, cpu.node, cpu.sibling, cpu.id);
+                break;
+
+            case PlacementPolicy::Llc:
+                if (cpu.sibling == 0 && rank.coreInLlc == 0) order.emplace_back(rank.llcInNode, cpu.node, 0, 0, cpu.id);
+                break;
+
+            case PlacementPolicy::Compact:
+                order.emplace_back(cpu.node, cpu.llc, cpu.core, cpu.sibling, cpu.id);
+                break;
+
+            default:
+                order.emplace_back(cpu.sibling, rank.coreInLlc, rank.llcInNode, cpu.node, cpu.id);
+                break;
+        }
+    }
+
+    std::sort(order.begin(), order.end());
+
+    std::vector<int> placement;
+
+    for (int i = 0; i < threadCount; i++)
+    {
+        placement.push_back(std::get<4>(order[i % order.size()]));
+    }
+
+    return placement;
+}
+
+int defaultThreadCount(const CpuTopology& topology, PlacementPolicy policy)
+{
+    switch (policy)
+    {
+        case PlacementPolicy::Core:
+            return std::max(1, topology.coreCount);
+
+        case PlacementPolicy::Llc:
+            return std::max(1, topology.llcCount);
+
+        default:
+            return std::max(1, static_cast<int>(topology.cpus.size()));
+    }
+}
+
+std::string describeTopology(const CpuTopology& topology)
+{
+    return std::to_string(topology.cpus.size()) + " CPUs lógicas, "
+        + std::to_string(topology.coreCount) + " núcleos, "
+        + std::to_string(topology.llcCount) + " domínios de última cache, "
+        + std::to_string(topology.nodeCount) + " nós NUMA";
+}
+
+} // namespace memstress
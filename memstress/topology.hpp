@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace memstress
+{
+
+// CPU logica que o processo pode usar e onde ela fica na topologia
+struct LogicalCpu
+{
+    int id;
+
+    // Indices sequenciais do nucleo fisico, do dominio da ultima cache e do no NUMA
+    int core;
+    int llc;
+    int node;
+
+    // Posicao entre os irmaos SMT do mesmo nucleo, 0 para o primeiro
+    int sibling;
+};
+
+// Topologia lida de /sys/devices/system/cpu e /sys/devices/system/node, restrita a afinidade do processo
+struct CpuTopology
+{
+    std::vector<LogicalCpu> cpus;
+
+    int coreCount = 0;
+    int llcCount = 0;
+    int nodeCount = 0;
+};
+
+// Como as threads sao presas as CPUs
+enum class PlacementPolicy
+{
+    None,     // sem afinidade, o escalonador decide
+    Core,     // uma thread por nucleo fisico, sem usar os irmaos SMT
+    Smt,      // threads em pares nos irmaos SMT de cada nucleo
+    Llc,      // uma thread por dominio da ultima cache
+    Compact,  // enche um nucleo, dominio e no antes de passar ao proximo
+    Scatter   // espalha entre nos, dominios e nucleos antes de repetir
+};
+
+// Topologia da maquina, lida uma vez na primeira chamada
+const CpuTopology& cpuTopology();
+
+// CPU de cada thread pela politica, vazio para None. Com mais threads que CPUs a lista se repete.
+std::vector<int> planPlacement(const CpuTopology& topology, PlacementPolicy policy, int threadCount);
+
+// Quantidade de threads que cobre a topologia na politica
+int defaultThreadCount(const CpuTopology& topology, PlacementPolicy policy);
+
+// Resumo da topologia para mostrar ao usuario
+std::string describeTopology(const CpuTopology& topology);
+
+} // namespace memstress
@@ -0,0 +1,343 @@
+#include "memstress/trace.hpp"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+namespace memstress
+{
+
+namespace
+{
+
+// Primeiros bytes do arquivo, mudam quando o formato mudar
+const char traceMagic[] = "MSTRACE1";
+const size_t traceMagicSize = sizeof(traceMagic) - 1;
+
+// Marcadores de lote e do final com os descartes
+const char batchMarker = 'B';
+const char endMarker = 'E';
+
+// Intervalo entre as gravacoes, curto para os aneis nao encherem entre uma e outra
+const int flushMillis = 20;
+
+// Maior cabecalho de lote codificado (marcador e tres varints) e maior codificacao de uma palavra do anel
+// (a inversao: tipo, varint e valor; a troca e a falha usam menos por palavra)
+const size_t maxBatchHeaderBytes = 1 + 3 * 10;
+const size_t maxWordBytes = 1 + 10 + 1;
+
+// Escreve o varint em out e retorna o fim dele. O gravador reserva o pior caso antes, sem conferir a cada byte.
+char * putVarint(char * out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        *out++ = static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+
+    *out++ = static_cast<char>(value);
+    return out;
+}
+
+// Delta com sinal em um varint curto: 0, -1, 1, -2... viram 0, 1, 2, 3...
+uint64_t zigzag(uint64_t current, uint64_t previous)
+{
+    int64_t delta = static_cast<int64_t>(current - previous);
+    return (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+}
+
+uint64_t unzigzag(uint64_t value, uint64_t previous)
+{
+    int64_t delta = static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    return previous + static_cast<uint64_t>(delta);
+}
+
+} // namespace
+
+TraceRing::TraceRing(size_t blocks, size_t blockWords)
+    : words(blocks * blockWords), blockCount(blocks), blockWords(blockWords)
+{
+}
+
+TraceWriter::TraceWriter(const std::string& path, int threadCount, size_t ringBlocks, size_t blockWords, long long maxBytes)
+    : path(path), file(path, std::ios::binary | std::ios::trunc), maxBytes(maxBytes),
+      lastPosition(threadCount, 0), lastNanos(threadCount, 0), truncated(threadCount, 0)
+{
+    if (!file)
+    {
+        firstError = path + ": " + std::strerror(errno);
+        return;
+    }
+
+    for (int i = 0; i < threadCount; i++) rings.push_back(std::make_unique<TraceRing>(ringBlocks, blockWords));
+
+    encoded.resize(ringBlocks * (maxBatchHeaderBytes + (blockWords - 2) * maxWordBytes));
+
+    char header[traceMagicSize + 10];
+    std::memcpy(header, traceMagic, traceMagicSize);
+    char * end = putVarint(header + traceMagicSize, threadCount);
+
+    file.write(header, end - header);
+    bytes = end - header;
+
+    flusher = std::thread(&TraceWriter::flushLoop, this);
+}
+
+TraceWriter::~TraceWriter()
+{
+    finish();
+}
+
+void TraceWriter::finish()
+{
+    if (!flusher.joinable()) return;
+
+    stopRequested.store(true);
+    flusher.join();
+
+    // As threads de estresse ja terminaram, o que sobrou nos aneis vai agora
+    flush();
+
+    char * out = encoded.data();
+    *out++ = endMarker;
+    out = putVarint(out, rings.size());
+
+    for (size_t i = 0; i < rings.size(); i++) out = putVarint(out, rings[i]->droppedBlocks() + truncated[i]);
+
+    file.write(encoded.data(), out - encoded.data());
+    bytes += out - encoded.data();
+
+    file.close();
+    if (!file && firstError.empty()) firstError = path + ": " + std::strerror(errno);
+}
+
+long long TraceWriter::droppedBlocks() const
+{
+    long long total = 0;
+
+    for (size_t i = 0; i < rings.size(); i++) total += rings[i]->droppedBlocks() + truncated[i];
+
+    return total;
+}
+
+long long TraceWriter::droppedFaults() const
+{
+    long long total = 0;
+
+    for (const std::unique_ptr<TraceRing>& ring : rings) total += ring->droppedFaults();
+
+    return total;
+}
+
+void TraceWriter::flushLoop()
+{
+    while (!stopRequested.load())
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(flushMillis));
+        flush();
+    }
+}
+
+// Codifica os lotes de cada anel direto dos blocos, sem copia intermediaria. Passado o limite do arquivo os
+// aneis continuam sendo esvaziados, para as threads nao perderem lotes a toa, mas os lotes so entram na
+// contagem do final.
+void TraceWriter::flush()
+{
+    for (size_t thread = 0; thread < rings.size(); thread++)
+    {
+        TraceRing& ring = *rings[thread];
+        char * out = encoded.data();
+
+        uint64_t& position = lastPosition[thread];
+        uint64_t& nanos = lastNanos[thread];
+
+        ring.drain(ring.pending(), [&](const uint64_t * block) {
+            if (full)
+            {
+                truncated[thread]++;
+                return;
+            }
+
+            char * batchStart = out;
+            uint64_t batchPosition = position;
+            const uint64_t * words = block + 2;
+            uint64_t wordCount = block[1];
+
+            *out++ = batchMarker;
+            out = putVarint(out, thread);
+            out = putVarint(out, block[0] - nanos);
+            out = putVarint(out, wordCount);
+
+            for (uint64_t i = 0; i < wordCount; i++)
+            {
+                uint64_t word = words[i];
+                uint64_t wordPosition = traceWordPosition(word);
+                TraceEventType type = traceWordType(word);
+
+                *out++ = static_cast<char>(type);
+                out = putVarint(out, zigzag(wordPosition, position));
+                position = wordPosition;
+
+                if (type == TraceEventType::Invert)
+                {
+                    *out++ = static_cast<char>(traceWordValue(word));
+                }
+                else if (type == TraceEventType::Swap)
+                {
+                    uint64_t second = words[++i];
+
+                    out = putVarint(out, zigzag(traceWordPosition(second), position));
+                    *out++ = static_cast<char>(traceWordValue(word));
+                    *out++ = static_cast<char>(traceWordValue(second));
+                    position = traceWordPosition(second);
+                }
+                else if (type == TraceEventType::Fault)
+                {
+                    out = putVarint(out, words[++i]);
+                }
+            }
+
+            if (maxBytes > 0 && bytes + (out - encoded.data()) > maxBytes)
+            {
+                // O lote que passou do limite sai inteiro, a base dos deltas volta para o lote anterior
+                out = batchStart;
+                position = batchPosition;
+                full = true;
+                truncated[thread]++;
+                return;
+            }
+
+            nanos = block[0];
+        });
+
+        file.write(encoded.data(), out - encoded.data());
+        bytes += out - encoded.data();
+
+        if (!file && firstError.empty()) firstError = path + ": " + std::strerror(errno);
+    }
+}
+
+TraceReader::TraceReader(const std::string& path)
+    : file(path, std::ios::binary)
+{
+    if (!file)
+    {
+        readError = path + ": " + std::strerror(errno);
+        return;
+    }
+
+    char magic[traceMagicSize];
+    uint64_t threads = 0;
+
+    if (!file.read(magic, traceMagicSize) || std::memcmp(magic, traceMagic, traceMagicSize) != 0 || !readVarint(threads)
+        || threads == 0)
+    {
+        readError = path + ": não é um trace do mem-stress ou é de outra versão";
+        return;
+    }
+
+    threadCount = static_cast<int>(threads);
+    lastPosition.assign(threadCount, 0);
+    lastNanos.assign(threadCount, 0);
+}
+
+bool TraceReader::readVarint(uint64_t& value)
+{
+    value = 0;
+
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+        int byte = file.get();
+        if (byte == EOF) return false;
+
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+
+    return false;
+}
+
+bool TraceReader::next(DecodedTraceEvent& event)
+{
+    if (!readError.empty()) return false;
+
+    event = DecodedTraceEvent();
+    uint64_t value = 0;
+
+    if (remainingInBlock == 0)
+    {
+        // Um arquivo sem o final eh de uma gravacao interrompida, os eventos lidos ate ali continuam valendo
+        int marker = file.get();
+        if (marker == EOF) return false;
+
+        if (marker == endMarker)
+        {
+            uint64_t threads = 0;
+            if (!readVarint(threads)) return false;
+
+            for (uint64_t i = 0; i < threads && readVarint(value); i++) dropped.push_back(static_cast<long long>(value));
+
+            return false;
+        }
+
+        uint64_t thread = 0;
+
+        if (marker != batchMarker || !readVarint(thread) || thread >= static_cast<uint64_t>(threadCount) || !readVarint(value)
+            || !readVarint(remainingInBlock))
+        {
+            readError = file.eof() ? "trace cortado no meio de um lote" : "lote inválido no trace";
+            return false;
+        }
+
+        currentThread = static_cast<int>(thread);
+        lastNanos[currentThread] += value;
+
+        event.thread = currentThread;
+        event.nanos = lastNanos[currentThread];
+        return true;
+    }
+
+    int type = file.get();
+    uint64_t& position = lastPosition[currentThread];
+    bool ok = type != EOF && readVarint(value);
+
+    event.thread = currentThread;
+    event.type = static_cast<TraceEventType>(type);
+    event.nanos = lastNanos[currentThread];
+    event.first = position = unzigzag(value, position);
+
+    // A troca e a falha ocupavam duas palavras no anel
+    switch (event.type)
+    {
+        case TraceEventType::Invert:
+            event.firstValue = static_cast<uint8_t>(file.get());
+            remainingInBlock -= 1;
+            break;
+
+        case TraceEventType::Swap:
+            ok = ok && readVarint(value);
+            event.second = position = unzigzag(value, event.first);
+            event.firstValue = static_cast<uint8_t>(file.get());
+            event.secondValue = static_cast<uint8_t>(file.get());
+            remainingInBlock -= 2;
+            break;
+
+        case TraceEventType::Fault:
+            ok = ok && readVarint(event.second);
+            remainingInBlock -= 2;
+            break;
+
+        default:
+            ok = false;
+    }
+
+    if (!ok || !file || remainingInBlock > (1ULL << 62))
+    {
+        readError = file.eof() ? "trace cortado no meio de um lote" : "evento inválido no trace";
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace memstress
@@ -0,0 +1,233 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace memstress
+{
+
+enum class TraceEventType : uint8_t
+{
+    Batch = 0,   // inicio de um lote de operacoes, com o instante
+    Invert = 1,  // inversao de uma posicao e o valor escrito
+    Swap = 2,    // troca de duas posicoes e os valores escritos
+    Fault = 3    // posicao onde a conferencia falhou e a sequencia do gerador
+};
+
+// Palavra de 64 bits de um evento no anel: posicao nos 48 bits baixos, valor escrito nos 8 seguintes e o
+// tipo no byte alto. A troca ocupa duas palavras, uma por posicao; a falha ocupa a palavra da posicao e
+// uma com a sequencia do gerador. Uma escrita por operacao, sem campos de byte, eh o que mantem o custo do
+// trace no laco quente em poucos por cento.
+inline uint64_t traceWord(TraceEventType type, uint64_t position, uint64_t value)
+{
+    return static_cast<uint64_t>(type) << 56 | (value & 0xff) << 48 | (position & ((1ULL << 48) - 1));
+}
+
+inline TraceEventType traceWordType(uint64_t word) { return static_cast<TraceEventType>(word >> 56); }
+inline uint64_t traceWordPosition(uint64_t word) { return word & ((1ULL << 48) - 1); }
+inline uint8_t traceWordValue(uint64_t word) { return static_cast<uint8_t>(word >> 48); }
+
+// Anel pre-alocado de uma thread, um produtor (a thread de estresse) e um consumidor (o gravador). O anel
+// eh dividido em blocos de tamanho fixo, um por lote de operacoes: a thread pega um bloco no inicio do lote,
+// escreve as palavras sem conferir espaco e entrega o bloco no fim; o bloco precisa caber as operacoes de
+// um lote, e as falhas so usam a folga reservada para elas. Sem bloco livre o lote inteiro fica
+// fora do trace e eh contado, a thread de estresse nunca espera pelo disco.
+//
+// Bloco: palavra 0 com os ns desde o inicio do estresse, palavra 1 com as palavras de evento usadas, e
+// os eventos a partir da palavra 2.
+class TraceRing
+{
+public:
+    TraceRing(size_t blocks, size_t blockWords);
+
+    // Espaco para eventos em cada bloco
+    size_t eventWords() const { return blockWords - 2; }
+
+    // Bloco do proximo lote, nulo se o gravador ainda nao liberou nenhum
+    uint64_t * beginBlock(uint64_t nanos)
+    {
+        uint64_t position = head.load(std::memory_order_relaxed);
+
+        // O indice do consumidor so eh relido quando o anel parece cheio, sem disputar a linha a cada lote
+        if (position - cachedTail >= blockCount)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+
+            if (position - cachedTail >= blockCount)
+            {
+                dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        uint64_t * block = blockAt(position);
+        block[0] = nanos;
+        return block + 2;
+    }
+
+    // Entrega o bloco ao gravador, end eh o fim das palavras escritas
+    void endBlock(const uint64_t * end)
+    {
+        uint64_t position = head.load(std::memory_order_relaxed);
+        uint64_t * block = blockAt(position);
+
+        block[1] = end - (block + 2);
+        head.store(position + 1, std::memory_order_release);
+    }
+
+    // Blocos esperando o gravador
+    size_t pending() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_relaxed);
+    }
+
+    // Passa ate limit blocos pendentes para visit e libera o espaco deles, chamado so pelo gravador
+    template <typename Visitor>
+    size_t drain(size_t limit, Visitor visit)
+    {
+        uint64_t position = tail.load(std::memory_order_relaxed);
+        uint64_t end = head.load(std::memory_order_acquire);
+
+        if (end - position > limit) end = position + limit;
+
+        for (uint64_t i = position; i != end; i++) visit(blockAt(i));
+
+        tail.store(end, std::memory_order_release);
+        return end - position;
+    }
+
+    // Lotes que ficaram fora do trace por falta de bloco livre
+    long long droppedBlocks() const { return dropped.load(std::memory_order_relaxed); }
+
+    // Falha que nao coube na folga do bloco, chamado so pela thread dona
+    void dropFault() { faultsDropped.store(faultsDropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+
+    long long droppedFaults() const { return faultsDropped.load(std::memory_order_relaxed); }
+
+private:
+    uint64_t * blockAt(uint64_t position) { return words.data() + (position % blockCount) * blockWords; }
+
+    std::vector<uint64_t> words;
+    size_t blockCount;
+    size_t blockWords;
+
+    alignas(64) std::atomic<uint64_t> head{0};
+    uint64_t cachedTail = 0;
+    std::atomic<long long> dropped{0};
+    std::atomic<long long> faultsDropped{0};
+
+    alignas(64) std::atomic<uint64_t> tail{0};
+};
+
+// Gravador do trace: esvazia os aneis das threads em segundo plano e grava os eventos codificados.
+//
+// Formato: "MSTRACE1", varint com a quantidade de threads e um bloco 'B' por lote: varints com a thread,
+// o delta de ns desde o lote anterior da thread e a quantidade de eventos. Cada evento eh o byte do tipo
+// seguido do delta (zigzag) da posicao em relacao a posicao anterior da thread: Invert com o valor,
+// Swap com o delta da segunda posicao e os dois valores, Fault com a sequencia do gerador. O final 'E'
+// traz os lotes descartados de cada thread.
+class TraceWriter
+{
+public:
+    // Cada thread tem um anel de ringBlocks blocos de blockWords palavras; a gravacao para ao atingir maxBytes
+    TraceWriter(const std::string& path, int threadCount, size_t ringBlocks, size_t blockWords, long long maxBytes);
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    // Primeira falha ao abrir ou escrever o arquivo, vazio se tudo deu certo
+    const std::string& error() const { return firstError; }
+
+    TraceRing& ring(int thread) { return *rings[thread]; }
+
+    // Esvazia os aneis uma ultima vez e fecha o arquivo, depois que as threads de estresse terminaram
+    void finish();
+
+    long long writtenBytes() const { return bytes; }
+
+    // Lotes fora do trace, por anel cheio ou pelo limite do arquivo
+    long long droppedBlocks() const;
+
+    // Falhas fora do trace por falta de folga no bloco do lote
+    long long droppedFaults() const;
+
+private:
+    void flushLoop();
+    void flush();
+
+    std::string path;
+    std::string firstError;
+    std::ofstream file;
+    std::vector<std::unique_ptr<TraceRing>> rings;
+    long long maxBytes;
+    long long bytes = 0;
+
+    // Ultima posicao e ultimo instante de cada thread, a base dos deltas
+    std::vector<uint64_t> lastPosition;
+    std::vector<uint64_t> lastNanos;
+
+    // Lotes que nao couberam no limite do arquivo, por thread
+    std::vector<long long> truncated;
+    bool full = false;
+
+    // Lote codificado, reaproveitado entre as gravacoes
+    std::vector<char> encoded;
+
+    std::atomic<bool> stopRequested{false};
+    std::thread flusher;
+};
+
+// Evento decodificado do arquivo, com a posicao absoluta e o instante do lote
+struct DecodedTraceEvent
+{
+    int thread = 0;
+    TraceEventType type = TraceEventType::Batch;
+    uint64_t nanos = 0;
+
+    // Posicao e a segunda posicao da troca, ou a sequencia na falha
+    uint64_t first = 0;
+    uint64_t second = 0;
+    uint8_t firstValue = 0;
+    uint8_t secondValue = 0;
+};
+
+// Leitor do formato do TraceWriter
+class TraceReader
+{
+public:
+    explicit TraceReader(const std::string& path);
+
+    // Vazio se o arquivo foi aberto e os eventos lidos ate agora sao validos
+    const std::string& error() const { return readError; }
+
+    int threads() const { return threadCount; }
+
+    // Proximo evento, false no fim do arquivo ou em erro. Cada lote aparece como um evento Batch antes
+    // das operacoes dele.
+    bool next(DecodedTraceEvent& event);
+
+    // Lotes descartados por thread, lidos do final do arquivo (vazio se a gravacao nao terminou)
+    const std::vector<long long>& droppedBlocks() const { return dropped; }
+
+private:
+    bool readVarint(uint64_t& value);
+
+    std::ifstream file;
+    std::string readError;
+    int threadCount = 0;
+
+    int currentThread = 0;
+    uint64_t remainingInBlock = 0;
+
+    std::vector<uint64_t> lastPosition;
+    std::vector<uint64_t> lastNanos;
+    std::vector<long long> dropped;
+};
+
+} // namespace memstress
@@ -0,0 +1,163 @@
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "libs/CLI11.hpp"
+#include "memstress/trace.hpp"
+
+using memstress::DecodedTraceEvent;
+using memstress::TraceEventType;
+using memstress::TraceReader;
+
+// Leitor dos arquivos gravados pelo mem-stress --trace. Mostra os eventos em texto, uma linha por evento,
+// ou so as operacoes que antecederam cada falha, o trecho que interessa para entender uma falha.
+
+// Contagem dos eventos de uma thread para o resumo
+struct ThreadCounts
+{
+    long long batches = 0;
+    long long inverts = 0;
+    long long swaps = 0;
+    long long faults = 0;
+    uint64_t lastNanos = 0;
+};
+
+void printEvent(std::ostream& out, const DecodedTraceEvent& event)
+{
+    out << "thread " << event.thread << " " << std::setw(14) << event.nanos << " ns  ";
+
+    switch (event.type)
+    {
+        case TraceEventType::Batch:
+            out << "lote";
+            break;
+
+        case TraceEventType::Invert:
+            out << "inversão posição " << event.first << " valor 0x" << std::hex << std::setw(2) << std::setfill('0')
+                << static_cast<int>(event.firstValue);
+            break;
+
+        case TraceEventType::Swap:
+            out << "troca    posições " << event.first << " e " << event.second << " valores 0x" << std::hex
+                << std::setw(2) << std::setfill('0') << static_cast<int>(event.firstValue) << " e 0x" << std::setw(2)
+                << static_cast<int>(event.secondValue);
+            break;
+
+        case TraceEventType::Fault:
+            out << "FALHA    posição " << event.first << " sequência " << event.second;
+            break;
+    }
+
+    out << std::dec << std::setfill(' ') << "\n";
+}
+
+int main(int argc, char **argv)
+{
+    CLI::App app{"Leitor dos traces do mem-stress"};
+
+    std::string path;
+    app.add_option("arquivo", path, "Arquivo gravado pelo mem-stress --trace")
+        ->required();
+
+    int thread{-1};
+    app.add_option("--thread", thread, "Mostra apenas os eventos desta thread")
+        ->check(CLI::NonNegativeNumber);
+
+    int beforeFault{0};
+    app.add_option("--before-fault", beforeFault, "Mostra apenas as falhas e os N eventos de cada thread que as antecederam")
+        ->check(CLI::NonNegativeNumber);
+
+    bool summaryOnly{false};
+    app.add_flag("--summary", summaryOnly, "Mostra apenas a contagem de eventos de cada thread");
+
+    CLI11_PARSE(app, argc, argv);
+
+    TraceReader reader(path);
+
+    if (!reader.error().empty())
+    {
+        std::cerr << reader.error() << std::endl;
+        return 1;
+    }
+
+    std::map<int, ThreadCounts> counts;
+
+    // Ultimos eventos de cada thread, mostrados quando aparece uma falha
+    std::vector<std::deque<DecodedTraceEvent>> recent(reader.threads());
+
+    DecodedTraceEvent event;
+
+    while (reader.next(event))
+    {
+        if (thread >= 0 && event.thread != thread) continue;
+
+        ThreadCounts& threadCounts = counts[event.thread];
+        threadCounts.lastNanos = event.nanos;
+
+        switch (event.type)
+        {
+            case TraceEventType::Batch: threadCounts.batches++; break;
+            case TraceEventType::Invert: threadCounts.inverts++; break;
+            case TraceEventType::Swap: threadCounts.swaps++; break;
+            case TraceEventType::Fault: threadCounts.faults++; break;
+        }
+
+        if (summaryOnly) continue;
+
+        if (beforeFault == 0)
+        {
+            printEvent(std::cout, event);
+            continue;
+        }
+
+        std::deque<DecodedTraceEvent>& history = recent[event.thread];
+
+        if (event.type == TraceEventType::Fault)
+        {
+            std::cout << "--- " << history.size() << " eventos antes da falha\n";
+
+            for (const DecodedTraceEvent& previous : history) printEvent(std::cout, previous);
+            printEvent(std::cout, event);
+
+            history.clear();
+            continue;
+        }
+
+        history.push_back(event);
+        if (history.size() > static_cast<size_t>(beforeFault)) history.pop_front();
+    }
+
+    // Um arquivo truncado tem os eventos ate o ponto do corte, o erro vem depois deles
+    if (!reader.error().empty()) std::cerr << path << ": " << reader.error() << std::endl;
+
+    if (summaryOnly || beforeFault > 0)
+    {
+        std::cout << "\nThread  Lotes       Inversões    Trocas       Falhas  Último instante (s)\n";
+
+        for (const auto& entry : counts)
+        {
+            std::cout << std::left << std::setw(8) << entry.first << std::setw(12) << entry.second.batches
+                << std::setw(13) << entry.second.inverts << std::setw(13) << entry.second.swaps
+                << std::setw(8) << entry.second.faults << entry.second.lastNanos / 1e9 << "\n";
+        }
+    }
+
+    const std::vector<long long>& dropped = reader.droppedBlocks();
+
+    if (dropped.empty())
+    {
+        std::cerr << path << ": sem o final do trace, a gravação foi interrompida" << std::endl;
+    } else {
+        for (size_t i = 0; i < dropped.size(); i++)
+        {
+            if (dropped[i] > 0 && (thread < 0 || thread == static_cast<int>(i)))
+            {
+                std::cerr << "Thread " << i << ": " << dropped[i] << " lotes descartados (anel cheio ou limite do arquivo)" << std::endl;
+            }
+        }
+    }
+
+    return reader.error().empty() ? 0 : 1;
+}